@@ -0,0 +1,170 @@
+#include "AabbKernel.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) && defined(__SSE2__)
+#define AABB_SSE2 1
+#include <immintrin.h>
+#endif
+
+// The AVX2 kernel is compiled for AVX2 on its own, the rest of the game
+// still runs on any x86-64. MSVC has no per function targets and stays on SSE2.
+#if AABB_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define AABB_AVX2 1
+#endif
+
+namespace {
+
+uint32_t overlapScalar(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY) {
+    uint32_t mask = 0;
+    for (int i = 0; i < AABB_LANES; i++) {
+        float left = std::max(query.minX, minX[i]);
+        float top = std::max(query.minY, minY[i]);
+        float right = std::min(query.maxX, maxX[i]);
+        float bottom = std::min(query.maxY, maxY[i]);
+        if (left < right && top < bottom) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#if AABB_SSE2
+
+uint32_t overlapSse2(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY) {
+    __m128 qMinX = _mm_set1_ps(query.minX);
+    __m128 qMinY = _mm_set1_ps(query.minY);
+    __m128 qMaxX = _mm_set1_ps(query.maxX);
+    __m128 qMaxY = _mm_set1_ps(query.maxY);
+
+    uint32_t mask = 0;
+    for (int half = 0; half < AABB_LANES; half += 4) {
+        __m128 left = _mm_max_ps(qMinX, _mm_loadu_ps(minX + half));
+        __m128 top = _mm_max_ps(qMinY, _mm_loadu_ps(minY + half));
+        __m128 right = _mm_min_ps(qMaxX, _mm_loadu_ps(maxX + half));
+        __m128 bottom = _mm_min_ps(qMaxY, _mm_loadu_ps(maxY + half));
+        __m128 hit = _mm_and_ps(_mm_cmplt_ps(left, right), _mm_cmplt_ps(top, bottom));
+        mask |= static_cast<uint32_t>(_mm_movemask_ps(hit)) << half;
+    }
+    return mask;
+}
+
+#endif
+
+#if AABB_AVX2
+
+__attribute__((target("avx2")))
+uint32_t overlapAvx2(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY) {
+    __m256 left = _mm256_max_ps(_mm256_set1_ps(query.minX), _mm256_loadu_ps(minX));
+    __m256 top = _mm256_max_ps(_mm256_set1_ps(query.minY), _mm256_loadu_ps(minY));
+    __m256 right = _mm256_min_ps(_mm256_set1_ps(query.maxX), _mm256_loadu_ps(maxX));
+    __m256 bottom = _mm256_min_ps(_mm256_set1_ps(query.maxY), _mm256_loadu_ps(maxY));
+    __m256 hit = _mm256_and_ps(_mm256_cmp_ps(left, right, _CMP_LT_OQ), _mm256_cmp_ps(top, bottom, _CMP_LT_OQ));
+    return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+}
+
+#endif
+
+bool supports(AabbKernelLevel level) {
+    switch (level) {
+    case AabbKernelLevel::Scalar:
+        return true;
+    case AabbKernelLevel::Sse2:
+#if AABB_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case AabbKernelLevel::Avx2:
+#if AABB_AVX2
+        // Other static initialisers may ask before the runtime set up the
+        // CPU model, so it is set up here. Doing it twice is harmless.
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+AabbKernel kernelFor(AabbKernelLevel level) {
+    switch (level) {
+#if AABB_AVX2
+    case AabbKernelLevel::Avx2:
+        return overlapAvx2;
+#endif
+#if AABB_SSE2
+    case AabbKernelLevel::Sse2:
+        return overlapSse2;
+#endif
+    default:
+        return overlapScalar;
+    }
+}
+
+// Read from every thread the bullet passes run on
+struct KernelChoice {
+    std::atomic<AabbKernelLevel> level;
+    std::atomic<AabbKernel> kernel;
+
+    KernelChoice() : level(bestAabbKernelLevel()), kernel(kernelFor(level.load())) {}
+};
+
+// Picked on first use, not during static initialisation, so nothing
+// depends on the order translation units are initialised in
+KernelChoice& current() {
+    static KernelChoice choice;
+    return choice;
+}
+
+}
+
+AabbKernel aabbKernel() {
+    return current().kernel.load(std::memory_order_relaxed);
+}
+
+AabbKernelLevel aabbKernelLevel() {
+    return current().level.load(std::memory_order_relaxed);
+}
+
+const char* aabbKernelName(AabbKernelLevel level) {
+    switch (level) {
+    case AabbKernelLevel::Scalar:
+        return "scalar";
+    case AabbKernelLevel::Sse2:
+        return "sse2";
+    case AabbKernelLevel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+AabbKernelLevel bestAabbKernelLevel() {
+    if (supports(AabbKernelLevel::Avx2)) return AabbKernelLevel::Avx2;
+    if (supports(AabbKernelLevel::Sse2)) return AabbKernelLevel::Sse2;
+    return AabbKernelLevel::Scalar;
+}
+
+bool setAabbKernelLevel(AabbKernelLevel level) {
+    if (!supports(level)) return false;
+    current().level = level;
+    current().kernel = kernelFor(level);
+    return true;
+}
+
+void overlapAll(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY,
+    int count, uint8_t* hits) {
+    AabbKernel kernel = aabbKernel();
+    for (int first = 0; first < count; first += AABB_LANES) {
+        uint32_t mask = kernel(query, minX + first, minY + first, maxX + first, maxY + first)
+            & laneMask(count - first);
+        for (int lane = 0; lane < AABB_LANES && first + lane < count; lane++) {
+            hits[first + lane] = (mask >> lane) & 1;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+
+// Tests one rectangle against boxes stored as one array per edge, 8 boxes
+// per call. The result is a mask with bit i set when box i overlaps, by
+// the same float operations as sf::FloatRect::intersects, so either path
+// gives the same answer for every input.
+//
+// The widest version the CPU runs (AVX2, SSE2, or plain C++ elsewhere) is
+// picked the first time a kernel is needed, by asking the CPU with
+// __builtin_cpu_supports. setAabbKernelLevel() can switch it afterwards.
+
+// A rectangle as the edges the kernels compare
+struct AabbQuery {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    explicit AabbQuery(const sf::FloatRect& rect)
+        : minX(std::min(rect.left, rect.left + rect.width)),
+          minY(std::min(rect.top, rect.top + rect.height)),
+          maxX(std::max(rect.left, rect.left + rect.width)),
+          maxY(std::max(rect.top, rect.top + rect.height)) {}
+
+    AabbQuery(float minX, float minY, float maxX, float maxY)
+        : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+};
+
+// How many boxes one kernel call looks at. Edge arrays handed to the
+// kernels have to be readable this far past the last box.
+const int AABB_LANES = 8;
+
+enum class AabbKernelLevel {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+typedef uint32_t (*AabbKernel)(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY);
+
+// The kernel in use
+AabbKernel aabbKernel();
+AabbKernelLevel aabbKernelLevel();
+const char* aabbKernelName(AabbKernelLevel level);
+
+// Best level this CPU supports
+AabbKernelLevel bestAabbKernelLevel();
+
+// Use another level, false if the CPU can not run it. For benchmarks.
+bool setAabbKernelLevel(AabbKernelLevel level);
+
+// One byte per box, 1 where it overlaps query
+void overlapAll(const AabbQuery& query,
+    const float* minX, const float* minY, const float* maxX, const float* maxY,
+    int count, uint8_t* hits);
+
+// Bits set in mask from lowest to highest
+inline int lowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// Mask of the first count lanes
+inline uint32_t laneMask(int count) {
+    return count >= AABB_LANES ? (1u << AABB_LANES) - 1 : (1u << count) - 1;
+}
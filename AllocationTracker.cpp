@@ -0,0 +1,63 @@
+#include "AllocationTracker.hpp"
+
+#include "Profiler.hpp"
+
+#ifdef INFA_TRACK_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace {
+
+// Plain zero initialised thread locals, so operator new can use them
+// without anything being constructed or allocated first. The counts are
+// atomic because job system workers add to the counts of other threads.
+thread_local std::atomic<uint64_t> counts[PHASE_COUNT + 1];
+thread_local int openPhase = -1;
+
+// Set while a worker runs a job for another thread, null otherwise
+thread_local AllocationCharge charged = { nullptr, -1 };
+
+}
+
+uint64_t threadAllocations(int phase) {
+    return counts[phase + 1].load(std::memory_order_relaxed);
+}
+
+uint64_t threadAllocationTotal() {
+    uint64_t total = 0;
+    for (const auto& count : counts) total += count.load(std::memory_order_relaxed);
+    return total;
+}
+
+void setAllocationPhase(int phase) {
+    openPhase = phase;
+}
+
+AllocationCharge allocationCharge() {
+    return charged.counts != nullptr ? charged : AllocationCharge{ counts, openPhase };
+}
+
+AllocationCharge chargeAllocationsTo(const AllocationCharge& charge) {
+    AllocationCharge previous = allocationCharge();
+    // Charging a thread to itself is the same as not charging it elsewhere
+    charged = charge.counts == counts ? AllocationCharge{ nullptr, -1 } : charge;
+    return previous;
+}
+
+#ifdef INFA_TRACK_ALLOCATIONS
+
+// The standard forms of new[], nothrow new and every delete call these
+// two. Over-aligned types are not counted, nothing in the game uses them.
+void* operator new(std::size_t size) {
+    AllocationCharge charge = allocationCharge();
+    charge.counts[charge.phase + 1].fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+#endif
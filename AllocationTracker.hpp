@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Counts heap allocations per profiler phase, on the thread that made them.
+// A job system worker charges what it allocates while running a job to the
+// thread that handed the job out, so a parallel loop counts toward the
+// phase it ran in whatever the thread count.
+// Only builds configured with INFA_TRACK_ALLOCATIONS replace operator new to
+// do the counting, in every other build the counts stay 0.
+#ifdef INFA_TRACK_ALLOCATIONS
+const bool ALLOCATION_TRACKING = true;
+#else
+const bool ALLOCATION_TRACKING = false;
+#endif
+
+// Allocations this thread made so far while the phase was open. Phase -1
+// counts the ones made outside of any phase.
+uint64_t threadAllocations(int phase);
+
+// Every allocation this thread made so far
+uint64_t threadAllocationTotal();
+
+// Which phase new allocations of this thread are charged to, set by the
+// profiler whenever it switches phases
+void setAllocationPhase(int phase);
+
+// Where a thread's allocations are counted: a thread's counts and the phase
+// open on that thread
+struct AllocationCharge {
+    std::atomic<uint64_t>* counts;
+    int phase;
+};
+
+// Where this thread's allocations are counted right now
+AllocationCharge allocationCharge();
+
+// Counts this thread's allocations as charge from now on and returns the
+// charge that was in place, to be handed back once the job is done
+AllocationCharge chargeAllocationsTo(const AllocationCharge& charge);
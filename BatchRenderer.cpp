@@ -0,0 +1,71 @@
+#include "BatchRenderer.hpp"
+
+void BatchRenderer::draw(sf::RenderTarget& target, const RenderSnapshot& snapshot, float alpha) {
+    ships.clear();
+    houses.clear();
+    bullets.clear();
+    player.clear();
+
+    // Bullets fly in a straight line, so where they were a tick ago is
+    // known without keeping it
+    float behind = (1.f - alpha) * FIXED_DT;
+    for (const auto& bullet : snapshot.bullets) {
+        sf::Vector2f position = bullet.position - bullet.velocity * behind;
+        sf::FloatRect rect(position.x - BULLET_SIZE.x / 2.f, position.y - BULLET_SIZE.y / 2.f, BULLET_SIZE.x, BULLET_SIZE.y);
+        appendRect(bullets, rect, bullet.isPlayers ? sf::Color::Green : sf::Color::Red);
+    }
+
+    sf::Vector2f fleetOrigin = snapshot.previousFleetOrigin + (snapshot.fleetOrigin - snapshot.previousFleetOrigin) * alpha;
+    for (const auto& ship : snapshot.ships) {
+        appendOutline<ShipKind>(ships, fleetOrigin + ship.position, ship.color);
+    }
+
+    for (const auto& house : snapshot.houses) {
+        appendOutline<HouseKind>(houses, house.position, house.color);
+    }
+
+    sf::Vector2f playerPosition = snapshot.previousPlayerPosition +
+        (snapshot.player.position - snapshot.previousPlayerPosition) * alpha;
+    appendOutline<PlayerKind>(player, playerPosition - sf::Vector2f(PlayerKind::ORIGIN.x, PlayerKind::ORIGIN.y),
+        snapshot.player.color);
+
+    target.draw(bullets);
+    target.draw(ships);
+    target.draw(houses);
+    target.draw(player);
+}
+
+template <typename Kind>
+void BatchRenderer::appendOutline(sf::VertexArray& batch, const sf::Vector2f& offset, const sf::Color& color) {
+    constexpr OutlinePoint center = Kind::center();
+    sf::Vector2f middle = offset + sf::Vector2f(center.x, center.y);
+
+    sf::Vector2f first = offset + sf::Vector2f(Kind::OUTLINE[0].x, Kind::OUTLINE[0].y);
+    sf::Vector2f previous = first;
+    for (int i = 1; i <= Kind::pointCount(); i++) {
+        sf::Vector2f current = i < Kind::pointCount()
+            ? offset + sf::Vector2f(Kind::OUTLINE[i].x, Kind::OUTLINE[i].y)
+            : first;
+
+        batch.append(sf::Vertex(middle, color));
+        batch.append(sf::Vertex(previous, color));
+        batch.append(sf::Vertex(current, color));
+
+        previous = current;
+    }
+}
+
+void BatchRenderer::appendRect(sf::VertexArray& batch, const sf::FloatRect& rect, const sf::Color& color) {
+    sf::Vector2f topLeft(rect.left, rect.top);
+    sf::Vector2f topRight(rect.left + rect.width, rect.top);
+    sf::Vector2f bottomRight(rect.left + rect.width, rect.top + rect.height);
+    sf::Vector2f bottomLeft(rect.left, rect.top + rect.height);
+
+    batch.append(sf::Vertex(topLeft, color));
+    batch.append(sf::Vertex(topRight, color));
+    batch.append(sf::Vertex(bottomRight, color));
+
+    batch.append(sf::Vertex(topLeft, color));
+    batch.append(sf::Vertex(bottomRight, color));
+    batch.append(sf::Vertex(bottomLeft, color));
+}
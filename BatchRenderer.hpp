@@ -0,0 +1,29 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "RenderSnapshot.hpp"
+#include "Simulation.hpp"
+
+// Draws the world with one vertex array per kind of entity instead of one
+// draw call per entity. The arrays are refilled every frame but keep their
+// storage, so after the first few frames nothing is allocated.
+class BatchRenderer {
+public:
+    // alpha blends from the tick before the snapshot (0) to the snapshot (1)
+    void draw(sf::RenderTarget& target, const RenderSnapshot& snapshot, float alpha);
+
+private:
+    // Appends the kind's outline at offset as triangles, fanned out from
+    // the center of its bounds the same way sf::Shape renders it. Every
+    // entity of a kind has the same outline, only color and position come
+    // from the snapshot.
+    template <typename Kind>
+    static void appendOutline(sf::VertexArray& batch, const sf::Vector2f& offset, const sf::Color& color);
+    static void appendRect(sf::VertexArray& batch, const sf::FloatRect& rect, const sf::Color& color);
+
+    sf::VertexArray ships{ sf::Triangles };
+    sf::VertexArray houses{ sf::Triangles };
+    sf::VertexArray bullets{ sf::Triangles };
+    sf::VertexArray player{ sf::Triangles };
+};
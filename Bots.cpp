@@ -0,0 +1,62 @@
+#include "Bots.hpp"
+
+#include <cmath>
+
+namespace {
+
+// Stands still and holds fire
+InputFrame idleBot(const Simulation&, uint64_t) {
+    InputFrame input;
+    input.shoot = true;
+    return input;
+}
+
+// Walks under the lowest ship, the nearest one if several are as low, and
+// fires. Ship bullets are not dodged.
+InputFrame hunterBot(const Simulation& sim, uint64_t) {
+    InputFrame input;
+    input.shoot = true;
+    if (sim.ships.empty()) return input;
+
+    float playerX = sim.player.getShape().getPosition().x;
+    float bestY = -INFINITY;
+    float bestX = playerX;
+    for (int shipId = 0; shipId < sim.ships.size(); shipId++) {
+        sf::Vector2f position = sim.shipPosition(shipId);
+        float centerX = position.x + SHIP_SIZE.x / 2.f;
+        if (position.y > bestY || (position.y == bestY && std::abs(centerX - playerX) < std::abs(bestX - playerX))) {
+            bestY = position.y;
+            bestX = centerX;
+        }
+    }
+
+    // A few pixels off counts as under it, so it does not jitter
+    const float DEAD_ZONE = 4.f;
+    if (bestX < playerX - DEAD_ZONE) input.moveDir = -1;
+    if (bestX > playerX + DEAD_ZONE) input.moveDir = 1;
+    return input;
+}
+
+}
+
+InputFrame sweepBot(const Simulation&, uint64_t tick) {
+    InputFrame input;
+    input.moveDir = (tick / 120) % 2 == 0 ? 1 : -1;
+    input.shoot = true;
+    return input;
+}
+
+const BotEntry BOTS[] = {
+    { "sweep", "sweeps left and right while firing", sweepBot },
+    { "hunter", "walks under the lowest ship and fires", hunterBot },
+    { "idle", "stands still and fires", idleBot },
+};
+
+const int BOT_COUNT = sizeof(BOTS) / sizeof(BOTS[0]);
+
+Bot findBot(const std::string& name) {
+    for (int i = 0; i < BOT_COUNT; i++) {
+        if (name == BOTS[i].name) return BOTS[i].play;
+    }
+    return nullptr;
+}
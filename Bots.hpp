@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Simulation.hpp"
+
+// Plays in place of the keyboard when there is no window. A bot only looks
+// at the game and the tick, so a seeded game played by a bot always plays
+// out the same.
+typedef InputFrame (*Bot)(const Simulation& sim, uint64_t tick);
+
+struct BotEntry {
+    const char* name;
+    const char* description;
+    Bot play;
+};
+
+// Every bot, for --bot
+extern const BotEntry BOTS[];
+extern const int BOT_COUNT;
+
+// The bot with this name, null if there is none
+Bot findBot(const std::string& name);
+
+// Sweeps left and right every two seconds while holding fire
+InputFrame sweepBot(const Simulation& sim, uint64_t tick);
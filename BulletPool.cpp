@@ -0,0 +1,48 @@
+#include "BulletPool.hpp"
+
+void BulletPool::setCapacity(int playerBullets, int shipBullets) {
+    ownerCapacity[static_cast<int>(BulletOwner::Player)] = playerBullets;
+    ownerCapacity[static_cast<int>(BulletOwner::Ship)] = shipBullets;
+
+    size_t total = static_cast<size_t>(playerBullets) + static_cast<size_t>(shipBullets);
+    x.assign(total, 0.f);
+    y.assign(total, 0.f);
+    vx.assign(total, 0.f);
+    vy.assign(total, 0.f);
+    owner.assign(total, BulletOwner::Player);
+
+    clear();
+}
+
+bool BulletPool::spawn(const sf::Vector2f& position, const sf::Vector2f& velocity, BulletOwner who) {
+    int o = static_cast<int>(who);
+    if (ownerCount[o] >= ownerCapacity[o]) return false;
+
+    x[count] = position.x;
+    y[count] = position.y;
+    vx[count] = velocity.x;
+    vy[count] = velocity.y;
+    owner[count] = who;
+
+    ownerCount[o]++;
+    count++;
+    return true;
+}
+
+void BulletPool::remove(int id) {
+    ownerCount[static_cast<int>(owner[id])]--;
+    count--;
+
+    // Swap and pop
+    x[id] = x[count];
+    y[id] = y[count];
+    vx[id] = vx[count];
+    vy[id] = vy[count];
+    owner[id] = owner[count];
+}
+
+void BulletPool::clear() {
+    count = 0;
+    ownerCount[0] = 0;
+    ownerCount[1] = 0;
+}
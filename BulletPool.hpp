@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "SweptAabb.hpp"
+
+const sf::Vector2f BULLET_SIZE = sf::Vector2f(5, 15);
+const float BULLET_SPEED = 600.f;
+
+// Most bullets one owner may have in flight, see SimConfig. Both caps
+// together still fit an int id, and the arrays stay within a few tens of MB.
+const int MAX_BULLETS = 1 << 20;
+
+enum class BulletOwner : uint8_t {
+    Player,
+    Ship,
+};
+
+// Every bullet in the game, stored as one array per field.
+// The arrays are sized once from the per-owner caps and never grow, and a
+// bullet is removed by moving the last one into its place, so neither
+// spawning nor removing touches the heap or shifts the other bullets.
+class BulletPool {
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<BulletOwner> owner;
+
+    // Sets how many bullets each owner may have alive, drops all bullets
+    void setCapacity(int playerBullets, int shipBullets);
+
+    // Returns false when the owner already has as many bullets as allowed
+    bool spawn(const sf::Vector2f& position, const sf::Vector2f& velocity, BulletOwner who);
+    void remove(int id);
+    void clear();
+
+    int size() const { return count; }
+    int countOf(BulletOwner who) const { return ownerCount[static_cast<int>(who)]; }
+
+    // Bullets are centered on their position
+    sf::FloatRect bounds(int id) const {
+        return sf::FloatRect(x[id] - BULLET_SIZE.x / 2.f, y[id] - BULLET_SIZE.y / 2.f, BULLET_SIZE.x, BULLET_SIZE.y);
+    }
+
+    // The way the bullet came during its last move of dt seconds, relative
+    // to origin
+    SweptAabb path(int id, float dt, const sf::Vector2f& origin = sf::Vector2f()) const {
+        sf::Vector2f delta(vx[id] * dt, vy[id] * dt);
+        sf::FloatRect start = bounds(id);
+        start.left -= delta.x + origin.x;
+        start.top -= delta.y + origin.y;
+        return SweptAabb(start, delta);
+    }
+
+private:
+    int count = 0;
+    int ownerCount[2] = { 0, 0 };
+    int ownerCapacity[2] = { 0, 0 };
+};
@@ -0,0 +1,72 @@
+#include "CachedLayer.hpp"
+
+#include <cmath>
+
+namespace {
+    // The texture is cleared to transparent and drawn into with alpha
+    // blending, which leaves its colors premultiplied by their alpha.
+    // Drawing it back with plain alpha blending would darken soft edges.
+    const sf::BlendMode PREMULTIPLIED_ALPHA(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+}
+
+CachedLayer::CachedLayer(const sf::FloatRect& area) : area(area) {
+}
+
+CachedLayer::CachedLayer(const CachedLayer& other) : area(other.area) {
+}
+
+CachedLayer& CachedLayer::operator=(const CachedLayer& other) {
+    if (this != &other) {
+        setArea(other.area);
+    }
+    return *this;
+}
+
+void CachedLayer::setArea(const sf::FloatRect& area) {
+    if (area == this->area) return;
+
+    this->area = area;
+    texture.reset();
+    failed = false;
+    dirty = true;
+}
+
+void CachedLayer::draw(sf::RenderTarget& target, const std::function<void(sf::RenderTarget&)>& paint) {
+    if (area.width <= 0 || area.height <= 0) return;
+
+    if (dirty && !failed) {
+        failed = !render(paint);
+        dirty = false;
+    }
+
+    if (failed) {
+        paint(target);
+        return;
+    }
+
+    target.draw(sprite, sf::RenderStates(PREMULTIPLIED_ALPHA));
+}
+
+bool CachedLayer::render(const std::function<void(sf::RenderTarget&)>& paint) {
+    // Whole pixels, so the quad lines up with the window's pixels
+    sf::FloatRect pixels(std::floor(area.left), std::floor(area.top),
+        std::ceil(area.left + area.width) - std::floor(area.left),
+        std::ceil(area.top + area.height) - std::floor(area.top));
+
+    if (!texture) {
+        texture.reset(new sf::RenderTexture());
+        if (!texture->create(static_cast<unsigned int>(pixels.width), static_cast<unsigned int>(pixels.height))) {
+            texture.reset();
+            return false;
+        }
+    }
+
+    texture->setView(sf::View(pixels));
+    texture->clear(sf::Color::Transparent);
+    paint(*texture);
+    texture->display();
+
+    sprite.setTexture(texture->getTexture(), true);
+    sprite.setPosition(pixels.left, pixels.top);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <memory>
+
+// A part of the screen that rarely changes, such as the planet or a menu's
+// backdrop and titles. It is rendered into a texture the first time it is
+// drawn and drawn back as one textured quad from then on, until it is
+// invalidated. Only the area it covers is kept, not the whole window.
+//
+// If the texture can not be made the layer is painted straight into the
+// target every frame instead, so it still shows up.
+class CachedLayer {
+public:
+    CachedLayer() = default;
+    explicit CachedLayer(const sf::FloatRect& area);
+
+    // A copy renders its own texture the first time it is drawn
+    CachedLayer(const CachedLayer& other);
+    CachedLayer& operator=(const CachedLayer& other);
+
+    // In the target's coordinates. Changing it invalidates the layer.
+    void setArea(const sf::FloatRect& area);
+    const sf::FloatRect& getArea() const { return area; }
+
+    void invalidate() { dirty = true; }
+
+    // paint draws the layer's content in the target's coordinates and is
+    // only called when the layer has to be rendered again
+    void draw(sf::RenderTarget& target, const std::function<void(sf::RenderTarget&)>& paint);
+
+private:
+    bool render(const std::function<void(sf::RenderTarget&)>& paint);
+
+    sf::FloatRect area;
+    std::unique_ptr<sf::RenderTexture> texture;
+    sf::Sprite sprite;
+    bool dirty = true;
+    bool failed = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+// Numbers given on the command line. Each parse only takes text that is a
+// whole number in [min, max] and leaves value as it was otherwise, so a
+// typo is reported instead of ending the program with an exception.
+
+inline bool parseInt(const char* text, int& value,
+    int min = std::numeric_limits<int>::min(), int max = std::numeric_limits<int>::max()) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// strtoull takes "-1" as the largest value, a seed has to be written as is
+inline bool parseUint64(const char* text, uint64_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || std::string(text).find('-') != std::string::npos) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Also refuses nan and the infinities
+inline bool parseFloat(const char* text, float& value,
+    float min = std::numeric_limits<float>::lowest(), float max = std::numeric_limits<float>::max()) {
+    char* end = nullptr;
+    errno = 0;
+    float parsed = std::strtof(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !(parsed >= min && parsed <= max)) return false;
+    value = parsed;
+    return true;
+}
+
+// Reports an option whose value did not parse, returns the exit code
+inline int badOption(const std::string& option, const char* value, const char* usage) {
+    std::cerr << "Bad value for " << option << ": " << value << "\n" << usage;
+    return 1;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Plain stand-ins for sf::Vector2f, sf::FloatRect and sf::Color, which can
+// not be used in constant expressions
+struct OutlinePoint {
+    float x;
+    float y;
+};
+
+struct OutlineBox {
+    float left;
+    float top;
+    float width;
+    float height;
+};
+
+struct PaletteColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+// Smallest box around an outline
+template <size_t N>
+constexpr OutlineBox outlineBounds(const OutlinePoint (&points)[N]) {
+    float left = points[0].x, top = points[0].y, right = left, bottom = top;
+    for (size_t i = 1; i < N; i++) {
+        left = std::min(left, points[i].x);
+        top = std::min(top, points[i].y);
+        right = std::max(right, points[i].x);
+        bottom = std::max(bottom, points[i].y);
+    }
+    return { left, top, right - left, bottom - top };
+}
+
+// Tint by how much health is left, in fifths
+constexpr PaletteColor HEALTH_PALETTE[6] = {
+    { 255, 0, 0 },      // Red
+    { 255, 165, 0 },    // Orange
+    { 255, 255, 0 },    // Yellow
+    { 144, 238, 144 },  // Green
+    { 173, 216, 230 },  // Light Blue
+    { 255, 255, 255 },  // White, only at full health
+};
+
+// Palette entry for the health left. Integer math gives the same steps as
+// comparing lives / maxLives against 0.2, 0.4, 0.6 and 0.8.
+constexpr int healthStep(int lives, int maxLives) {
+    return maxLives <= 0 ? 0
+        : lives == maxLives ? 5
+        : std::min(std::max(lives * 5 / maxLives, 0), 4);
+}
+
+static_assert(healthStep(8, 8) == 5 && healthStep(7, 8) == 4 && healthStep(4, 8) == 2 && healthStep(0, 8) == 0,
+    "health steps");
+
+// Everything about a kind of entity that is the same for all of them.
+// Kind supplies the tables, this turns them into what the game needs, so
+// picking the kind is a template argument and never a virtual call.
+template <typename Kind>
+struct EntityKind {
+    static constexpr int pointCount() {
+        return sizeof(Kind::OUTLINE) / sizeof(Kind::OUTLINE[0]);
+    }
+
+    // The fan the outline is drawn as starts here
+    static constexpr OutlinePoint center() {
+        return { Kind::BOUNDS.left + Kind::BOUNDS.width / 2.f, Kind::BOUNDS.top + Kind::BOUNDS.height / 2.f };
+    }
+
+    static sf::FloatRect bounds(const sf::Vector2f& position) {
+        return sf::FloatRect(position.x + Kind::BOUNDS.left, position.y + Kind::BOUNDS.top,
+            Kind::BOUNDS.width, Kind::BOUNDS.height);
+    }
+
+    static sf::Color tint(int lives, int maxLives) {
+        const PaletteColor& color = HEALTH_PALETTE[healthStep(lives, maxLives)];
+        return sf::Color(color.r, color.g, color.b);
+    }
+
+    // For the player, the only entity that still is an sf::Shape
+    static sf::ConvexShape makeShape() {
+        sf::ConvexShape shape(pointCount());
+        for (int i = 0; i < pointCount(); i++) {
+            shape.setPoint(i, sf::Vector2f(Kind::OUTLINE[i].x, Kind::OUTLINE[i].y));
+        }
+        return shape;
+    }
+};
+
+// Positions are the bottom left corner of ships and houses
+
+struct ShipKind : EntityKind<ShipKind> {
+    static constexpr int START_LIVES = 1;
+
+    // 50 x 20
+    static constexpr OutlinePoint OUTLINE[] = {
+        { 10, 0 }, { 0, -5 }, { 0, -10 }, { 10, -10 }, { 10, -15 }, { 15, -20 },
+        { 35, -20 }, { 40, -15 }, { 40, -10 }, { 50, -10 }, { 50, -5 }, { 40, 0 },
+    };
+    static constexpr OutlineBox BOUNDS = outlineBounds(OUTLINE);
+};
+
+struct HouseKind : EntityKind<HouseKind> {
+    static constexpr int START_LIVES = 8;
+
+    // 50 x 30
+    static constexpr OutlinePoint OUTLINE[] = {
+        { 0, 0 }, { 0, -30 }, { 50, -30 }, { 50, 0 },
+        { 40, 0 }, { 40, -10 }, { 10, -10 }, { 10, 0 },
+    };
+    static constexpr OutlineBox BOUNDS = outlineBounds(OUTLINE);
+};
+
+// The player's position is the middle of its outline, see Player
+struct PlayerKind : EntityKind<PlayerKind> {
+    static constexpr int START_LIVES = 2;
+
+    static constexpr OutlinePoint OUTLINE[] = {
+        { 0, 0 }, { 0, -10 }, { 15, -30 }, { 40, -30 }, { 55, -10 }, { 55, 0 },
+    };
+    static constexpr OutlineBox BOUNDS = outlineBounds(OUTLINE);
+    static constexpr OutlinePoint ORIGIN = { 55.f / 2.f, -30.f / 2.f };
+};
+
+static_assert(ShipKind::BOUNDS.width == 50 && ShipKind::BOUNDS.height == 20, "ship outline does not match SHIP_SIZE");
+static_assert(HouseKind::BOUNDS.width == 50 && HouseKind::BOUNDS.height == 30, "house outline does not match HOUSE_SIZE");
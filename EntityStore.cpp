@@ -0,0 +1,121 @@
+#include "EntityStore.hpp"
+
+template <typename Kind>
+EntityHandle EntityStore<Kind>::allocateHandle(int id) {
+    EntityHandle handle;
+    if (!freeSlots.empty()) {
+        handle.slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        handle.slot = static_cast<uint32_t>(generations.size());
+        generations.push_back(0);
+        slotIds.push_back(-1);
+        // Every slot can end up free, removing never has to grow the list
+        if (freeSlots.capacity() < generations.capacity()) {
+            freeSlots.reserve(generations.capacity());
+        }
+    }
+    handle.generation = generations[handle.slot];
+
+    slotIds[handle.slot] = id;
+    handles.push_back(handle);
+    return handle;
+}
+
+template <typename Kind>
+EntityHandle EntityStore<Kind>::create(const sf::Vector2f& at, int startLives) {
+    EntityHandle handle = allocateHandle(size());
+
+    position.push_back(at);
+    column.push_back(0);
+    row.push_back(0);
+    lives.push_back(startLives);
+    maxLives.push_back(startLives);
+    tint.push_back(Kind::tint(startLives, startLives));
+
+    return handle;
+}
+
+template <typename Kind>
+void EntityStore<Kind>::remove(int id) {
+    EntityHandle gone = handles[id];
+    generations[gone.slot]++;
+    slotIds[gone.slot] = -1;
+    freeSlots.push_back(gone.slot);
+
+    // Swap and pop
+    int last = size() - 1;
+    if (id != last) {
+        handles[id] = handles[last];
+        slotIds[handles[id].slot] = id;
+
+        position[id] = position[last];
+        column[id] = column[last];
+        row[id] = row[last];
+        lives[id] = lives[last];
+        maxLives[id] = maxLives[last];
+        tint[id] = tint[last];
+    }
+
+    handles.pop_back();
+    position.pop_back();
+    column.pop_back();
+    row.pop_back();
+    lives.pop_back();
+    maxLives.pop_back();
+    tint.pop_back();
+}
+
+template <typename Kind>
+void EntityStore<Kind>::clear() {
+    // Handles to the old entities have to stop working
+    for (const auto& handle : handles) {
+        generations[handle.slot]++;
+        slotIds[handle.slot] = -1;
+        freeSlots.push_back(handle.slot);
+    }
+
+    handles.clear();
+    position.clear();
+    column.clear();
+    row.clear();
+    lives.clear();
+    maxLives.clear();
+    tint.clear();
+}
+
+template <typename Kind>
+void EntityStore<Kind>::assign(const EntityStore& other) {
+    clear();
+
+    // The components are copied as whole arrays, into the capacity the old
+    // entities left behind. Only the handles are handed out one by one.
+    position = other.position;
+    column = other.column;
+    row = other.row;
+    lives = other.lives;
+    maxLives = other.maxLives;
+    tint = other.tint;
+
+    handles.reserve(other.size());
+    for (int id = 0; id < other.size(); id++) {
+        allocateHandle(id);
+    }
+}
+
+template <typename Kind>
+void EntityStore<Kind>::setLives(int id, int newLives, int newMaxLives) {
+    lives[id] = newLives;
+    maxLives[id] = newMaxLives;
+    tint[id] = Kind::tint(newLives, newMaxLives);
+}
+
+template <typename Kind>
+void EntityStore<Kind>::damage(int id, int amount) {
+    lives[id] -= amount;
+    tint[id] = Kind::tint(lives[id], maxLives[id]);
+}
+
+// The only kinds kept in stores
+template class EntityStore<ShipKind>;
+template class EntityStore<HouseKind>;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "EntityKinds.hpp"
+
+// Refers to one entity of an EntityStore for as long as it lives.
+// Entities move around inside the store when others are removed, a handle
+// does not. Once the entity is gone its slot may be reused, the generation
+// tells the new entity apart from the old one.
+struct EntityHandle {
+    static const uint32_t NONE = 0xffffffff;
+
+    uint32_t slot = NONE;
+    uint32_t generation = 0;
+
+    bool isNull() const { return slot == NONE; }
+
+    bool operator==(const EntityHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+// Every entity of one kind (ships or houses), stored as one array per
+// component like the BulletPool. An entity's id is its index into the
+// arrays. Removing one moves the last entity into its place, so removal is
+// constant time and the arrays stay packed for the passes that walk them.
+// Kind is one of EntityKinds.hpp and supplies the starting lives and tints.
+template <typename Kind>
+class EntityStore {
+public:
+    // Ships: offset of the ship from the fleet origin.
+    // Houses: position of the house's bottom left corner.
+    std::vector<sf::Vector2f> position;
+    // Slot in the fleet grid, ships only
+    std::vector<int32_t> column;
+    std::vector<int32_t> row;
+    std::vector<int32_t> lives;
+    std::vector<int32_t> maxLives;
+    // Color to draw with, follows lives, see EntityKind::tint()
+    std::vector<sf::Color> tint;
+
+    // New entity at full health
+    EntityHandle create(const sf::Vector2f& at, int startLives = Kind::START_LIVES);
+    // Moves the last entity into id
+    void remove(int id);
+    void clear();
+    // Replaces every entity with a copy of other's. Handles to the old
+    // entities stop working, unlike assigning the store.
+    void assign(const EntityStore& other);
+
+    void setLives(int id, int newLives, int newMaxLives);
+    void damage(int id, int amount);
+
+    int size() const { return static_cast<int>(handles.size()); }
+    bool empty() const { return handles.empty(); }
+
+    EntityHandle handle(int id) const { return handles[id]; }
+    // Id of the entity, -1 if it was removed
+    int find(const EntityHandle& handle) const {
+        if (handle.slot >= generations.size() || generations[handle.slot] != handle.generation) return -1;
+        return slotIds[handle.slot];
+    }
+
+private:
+    // Gives entity id a slot, reusing a free one first
+    EntityHandle allocateHandle(int id);
+
+    // Per id
+    std::vector<EntityHandle> handles;
+
+    // Per slot, the id of the entity using it and its current generation
+    std::vector<int32_t> slotIds;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;
+};
+
+typedef EntityStore<ShipKind> ShipStore;
+typedef EntityStore<HouseKind> HouseStore;
@@ -0,0 +1,31 @@
+#include "FormationIndex.hpp"
+
+void FormationIndex::reset(int columns, int rows) {
+    columnCount = columns;
+    rowCount = rows;
+
+    slots.assign(columns * rows, EntityHandle());
+    bottomRow.assign(columns, -1);
+}
+
+void FormationIndex::place(int column, int row, const EntityHandle& ship) {
+    slots[column * rowCount + row] = ship;
+
+    if (row > bottomRow[column]) {
+        bottomRow[column] = row;
+    }
+}
+
+void FormationIndex::remove(int column, int row) {
+    slots[column * rowCount + row] = EntityHandle();
+
+    if (row != bottomRow[column]) return;
+
+    // Walk up to the next living ship. Every row is walked past at most
+    // once per wave, so this is constant time spread over all the deaths.
+    int next = row - 1;
+    while (next >= 0 && slots[column * rowCount + next].isNull()) {
+        next--;
+    }
+    bottomRow[column] = next;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "EntityStore.hpp"
+
+// Which ship sits in every slot of the fleet grid, and which living ship is
+// the lowest one of every column. Only that ship can shoot and only it can
+// reach the houses, so both questions cost one lookup per column.
+//
+// Ships have no position of their own. A slot sits at a fixed offset from
+// the formation origin, so moving the whole fleet is moving the origin.
+class FormationIndex {
+public:
+    // Empty every slot of a columns x rows grid
+    void reset(int columns, int rows);
+
+    // Top left slot position and the distance between neighbouring slots
+    void setLayout(const sf::Vector2f& newOrigin, const sf::Vector2f& newPitch) {
+        origin = newOrigin;
+        pitch = newPitch;
+    }
+
+    void move(const sf::Vector2f& offset) {
+        origin += offset;
+    }
+
+    const sf::Vector2f& getOrigin() const { return origin; }
+    const sf::Vector2f& getPitch() const { return pitch; }
+
+    // Slot position relative to the origin
+    sf::Vector2f slotOffset(int column, int row) const {
+        return sf::Vector2f(column * pitch.x, row * pitch.y);
+    }
+
+    sf::Vector2f slotPosition(int column, int row) const {
+        return origin + slotOffset(column, row);
+    }
+
+    // Ship in a slot, a null handle if the slot is empty
+    EntityHandle slotShip(int column, int row) const {
+        return slots[column * rowCount + row];
+    }
+
+    // Put a ship into a slot
+    void place(int column, int row, const EntityHandle& ship);
+
+    // The ship in this slot died
+    void remove(int column, int row);
+
+    // The lowest living ship in the column, a null handle if the column is empty
+    EntityHandle bottomShip(int column) const {
+        int row = bottomRow[column];
+        return row == -1 ? EntityHandle() : slots[column * rowCount + row];
+    }
+
+    int columns() const { return columnCount; }
+    int rows() const { return rowCount; }
+
+private:
+    sf::Vector2f origin;
+    sf::Vector2f pitch;
+
+    int columnCount = 0;
+    int rowCount = 0;
+
+    // Ship per slot, column by column. Handles stay valid while other ships
+    // die, so nothing here has to change when the ship list is reordered.
+    std::vector<EntityHandle> slots;
+    std::vector<int> bottomRow;
+};
@@ -0,0 +1,29 @@
+#include "FrameArena.hpp"
+
+FrameArena::FrameArena(size_t capacity)
+    : block(capacity > 0 ? new char[capacity] : nullptr), size(capacity) {
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    requested += bytes + alignment;
+
+    size_t start = (used + alignment - 1) / alignment * alignment;
+    if (start + bytes <= size) {
+        used = start + bytes;
+        return block.get() + start;
+    }
+
+    // new[] is aligned for every fundamental type
+    overflow.emplace_back(new char[bytes]);
+    return overflow.back().get();
+}
+
+void FrameArena::reset() {
+    if (requested > size) {
+        size = requested;
+        block.reset(new char[size]);
+    }
+    overflow.clear();
+    used = 0;
+    requested = 0;
+}
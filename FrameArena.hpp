@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Scratch memory for one tick. allocate() hands out pieces of one block and
+// reset() takes all of them back at once, so scratch data that only lives
+// for a tick costs no heap traffic. A tick that needs more than the block
+// gets the rest from the heap, and the next reset() grows the block so the
+// same tick fits next time.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 0);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    // Everything handed out since the last reset is invalid afterwards
+    void reset();
+
+    size_t capacity() const { return size; }
+
+private:
+    std::unique_ptr<char[]> block;
+    size_t size = 0;
+    size_t used = 0;
+
+    // Bytes asked for since the last reset, including what did not fit
+    size_t requested = 0;
+    std::vector<std::unique_ptr<char[]>> overflow;
+};
+
+// Lets standard containers live in a FrameArena. Freeing is left to the
+// arena's reset(), so a container must not outlive the tick it was made in.
+template <typename T>
+class FrameAllocator {
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U> friend class FrameAllocator;
+
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
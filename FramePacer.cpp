@@ -0,0 +1,50 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+const FramePacer::Clock::duration MIN_OVERSLEEP = std::chrono::microseconds(100);
+const FramePacer::Clock::duration MAX_OVERSLEEP = std::chrono::milliseconds(4);
+
+}
+
+FramePacer::FramePacer(float rate)
+    : nextFrame(Clock::now()), oversleep(std::chrono::milliseconds(1)) {
+    setRate(rate);
+}
+
+void FramePacer::setRate(float rate) {
+    period = rate > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.f / rate))
+        : Clock::duration::zero();
+}
+
+void FramePacer::wait() {
+    if (period == Clock::duration::zero()) return;
+
+    nextFrame += period;
+    if (nextFrame < Clock::now()) {
+        nextFrame = Clock::now();
+        return;
+    }
+    sleepUntil(nextFrame);
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+    Clock::time_point wakeAt = deadline - oversleep;
+    if (Clock::now() < wakeAt) {
+        std::this_thread::sleep_until(wakeAt);
+
+        // Moves an eighth of the way to how late this sleep was, with
+        // twice that as headroom
+        Clock::duration late = Clock::now() - wakeAt;
+        oversleep += (late * 2 - oversleep) / 8;
+        oversleep = std::min(std::max(oversleep, MIN_OVERSLEEP), MAX_OVERSLEEP);
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
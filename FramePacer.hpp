@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+
+// Holds a loop to a fixed rate by sleeping, not spinning, so a window
+// drawing a menu costs about as much CPU as the rate asks for.
+//
+// Sleeps wake up late by a varying amount, so the pacer sleeps until a
+// little before the deadline and yields for the rest. How early it wakes
+// follows how late the sleeps actually were.
+class FramePacer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit FramePacer(float rate);
+
+    // Frames per second, 0 runs unpaced
+    void setRate(float rate);
+
+    // Blocks until the next frame is due. A frame that ran late starts the
+    // next one right away instead of a burst of short frames.
+    void wait();
+
+    // Blocks until the given time, with the same early wake up
+    void sleepUntil(Clock::time_point deadline);
+
+private:
+    Clock::duration period;
+    Clock::time_point nextFrame;
+
+    // How late sleeps were recently, never below a tenth of a millisecond
+    Clock::duration oversleep;
+};
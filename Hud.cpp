@@ -0,0 +1,118 @@
+#include "Hud.hpp"
+
+#include <string>
+
+#include "Simulation.hpp"
+
+namespace {
+    const unsigned int HUD_TEXT_SIZE = 20;
+
+    // Where the number starts after a label, on the label's baseline
+    sf::Vector2f labelEnd(const sf::Text& label) {
+        sf::Vector2f end = label.findCharacterPos(label.getString().getSize());
+        end.y = label.getPosition().y + label.getCharacterSize();
+        return end;
+    }
+}
+
+void Hud::setFont(const sf::Font& font) {
+    this->font = &font;
+
+    for (int i = 0; i < 10; i++) {
+        digits[i] = font.getGlyph('0' + i, HUD_TEXT_SIZE, false);
+    }
+
+    float top = WINDOW_SIZE.y / 10. - 50.;
+
+    livesText = sf::Text("", font, HUD_TEXT_SIZE);
+    livesText.setFillColor(sf::Color::Red);
+    livesText.setPosition(sf::Vector2f(10., top));
+
+    scoreLabel = sf::Text("Score: ", font, HUD_TEXT_SIZE);
+    scoreLabel.setFillColor(sf::Color::Green);
+    scoreLabel.setPosition(sf::Vector2f(WINDOW_SIZE.x - 120., top));
+
+    roundLabel = sf::Text("Round: ", font, HUD_TEXT_SIZE);
+    roundLabel.setFillColor(sf::Color::Yellow);
+    roundLabel.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2 - 50, top));
+
+    // Sized once so laying out a number later never allocates
+    scoreDigits.resize(MAX_DIGITS * 4);
+    roundDigits.resize(MAX_DIGITS * 4);
+
+    score = round = totalLives = -1;
+}
+
+void Hud::update(int score, int round, int totalLives) {
+    if (score != this->score) {
+        this->score = score;
+        layoutNumber(scoreDigits, score, labelEnd(scoreLabel), scoreLabel.getFillColor());
+    }
+
+    if (round != this->round) {
+        this->round = round;
+        layoutNumber(roundDigits, round, labelEnd(roundLabel), roundLabel.getFillColor());
+    }
+
+    // Lives only change when a ship lands a hit
+    if (totalLives != this->totalLives) {
+        this->totalLives = totalLives;
+
+        std::string str;
+        for (int i = 0; i < totalLives; i++) {
+            str += "<3 ";
+        }
+        livesText.setString(str);
+    }
+}
+
+void Hud::layoutNumber(sf::VertexArray& quads, int value, sf::Vector2f baseline, const sf::Color& color) {
+    int digitValues[MAX_DIGITS];
+    int count = 0;
+
+    unsigned int rest = value < 0 ? 0 : static_cast<unsigned int>(value);
+    do {
+        digitValues[count++] = rest % 10;
+        rest /= 10;
+    } while (rest != 0 && count < MAX_DIGITS);
+
+    quads.resize(count * 4);
+
+    // Same quads sf::Text makes, padded by a pixel against bleeding
+    const float padding = 1.f;
+    float x = baseline.x;
+    for (int i = 0; i < count; i++) {
+        const sf::Glyph& glyph = digits[digitValues[count - 1 - i]];
+
+        float left = x + glyph.bounds.left - padding;
+        float top = baseline.y + glyph.bounds.top - padding;
+        float right = x + glyph.bounds.left + glyph.bounds.width + padding;
+        float bottom = baseline.y + glyph.bounds.top + glyph.bounds.height + padding;
+
+        float u1 = glyph.textureRect.left - padding;
+        float v1 = glyph.textureRect.top - padding;
+        float u2 = glyph.textureRect.left + glyph.textureRect.width + padding;
+        float v2 = glyph.textureRect.top + glyph.textureRect.height + padding;
+
+        sf::Vertex* quad = &quads[i * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1));
+        quad[2] = sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2));
+
+        x += glyph.advance;
+    }
+}
+
+void Hud::draw(sf::RenderTarget& target) const {
+    if (font == nullptr) return;
+
+    target.draw(livesText);
+    target.draw(scoreLabel);
+    target.draw(roundLabel);
+
+    // The digits live on the font's glyph page for this size
+    sf::RenderStates states(&font->getTexture(HUD_TEXT_SIZE));
+    target.draw(scoreDigits, states);
+    target.draw(roundDigits, states);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// Lives, score and round along the top of the play screen.
+// The labels are laid out once. The numbers are drawn as quads from the
+// font's digit glyphs, which are looked up once in setFont(), so a changed
+// value only rewrites a few vertices and an unchanged one costs nothing.
+class Hud {
+public:
+    void setFont(const sf::Font& font);
+
+    // Only what changed since the last call is laid out again
+    void update(int score, int round, int totalLives);
+
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    // Room for every digit of an int
+    static const int MAX_DIGITS = 10;
+
+    // Writes value's digits as quads starting at the baseline point
+    void layoutNumber(sf::VertexArray& quads, int value, sf::Vector2f baseline, const sf::Color& color);
+
+    const sf::Font* font = nullptr;
+    sf::Glyph digits[10];
+
+    sf::Text livesText;
+    sf::Text scoreLabel;
+    sf::Text roundLabel;
+
+    sf::VertexArray scoreDigits{ sf::Quads };
+    sf::VertexArray roundDigits{ sf::Quads };
+
+    int score = -1;
+    int round = -1;
+    int totalLives = -1;
+};
@@ -0,0 +1,114 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Tries a worker makes before it goes to sleep. Parallel loops come in
+// bursts within a tick, waking a sleeping thread costs more than this.
+const int SPIN_TRIES = 64;
+
+}
+
+JobSystem::JobSystem(int threads) {
+    int count = std::max(threads, 1);
+    for (int i = 0; i < count; i++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (int i = 1; i < count; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::run(int count, int grain, RangeFunction function, const void* context) {
+    // Ranges grow until every job fits a queue
+    int maxJobs = JOB_QUEUE_SIZE * static_cast<int>(queues.size());
+    grain = std::max({ grain, 1, (count + maxJobs - 1) / maxJobs });
+    int jobCount = (count + grain - 1) / grain;
+    std::atomic<int> remaining{ jobCount };
+    AllocationCharge charge = allocationCharge();
+
+    // Dealt out round robin so every thread starts on its own share
+    for (int job = 0; job < jobCount; job++) {
+        int begin = job * grain;
+        int end = std::min(begin + grain, count);
+
+        Queue& queue = *queues[job % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pushBack({ function, context, begin, end, &remaining, charge });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued += jobCount;
+    }
+    wake.notify_all();
+
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(0)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::runOne(int self) {
+    Job job;
+    bool found = false;
+
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.count > 0) {
+            job = own.popBack();
+            found = true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size() && !found; i++) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.count > 0) {
+            job = victim.popFront();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    queued--;
+    AllocationCharge previous = chargeAllocationsTo(job.charge);
+    job.function(job.context, job.begin, job.end);
+    chargeAllocationsTo(previous);
+    job.remaining->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(int self) {
+    while (true) {
+        bool ranJob = false;
+        for (int i = 0; i < SPIN_TRIES; i++) {
+            if (runOne(self)) {
+                ranJob = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (ranJob) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AllocationTracker.hpp"
+
+// Small work-stealing scheduler. Every thread has its own queue of jobs;
+// a thread takes the newest job from its own queue and, once that is
+// empty, steals the oldest one from another thread's queue.
+//
+// The thread that calls parallelFor() runs jobs too and only returns once
+// all of them are done, so a parallel loop reads like a normal one.
+//
+// The queues are rings of JOB_QUEUE_SIZE jobs allocated up front, so
+// handing out and running jobs never touches the heap. A loop that would
+// need more jobs than fit gets larger ranges instead.
+class JobSystem {
+public:
+    static const int JOB_QUEUE_SIZE = 256;
+
+    // threads includes the calling thread, 1 runs everything inline
+    explicit JobSystem(int threads);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Runs body(begin, end) over [0, count) in ranges of about grain items.
+    // Small loops run inline, handing them out would cost more than they do.
+    template <typename Body>
+    void parallelFor(int count, int grain, const Body& body) {
+        if (count <= 0) return;
+        if (workers.empty() || count <= grain) {
+            body(0, count);
+            return;
+        }
+
+        run(count, grain, [](const void* context, int begin, int end) {
+            (*static_cast<const Body*>(context))(begin, end);
+        }, &body);
+    }
+
+private:
+    using RangeFunction = void (*)(const void* context, int begin, int end);
+
+    struct Job {
+        RangeFunction function;
+        const void* context;
+        int begin;
+        int end;
+        std::atomic<int>* remaining;
+        // The thread that handed the job out, its allocations count there
+        AllocationCharge charge;
+    };
+
+    // Owner takes from the back, thieves from the front
+    struct Queue {
+        std::mutex mutex;
+        Job jobs[JOB_QUEUE_SIZE];
+        int first = 0;
+        int count = 0;
+
+        void pushBack(const Job& job) {
+            jobs[(first + count) % JOB_QUEUE_SIZE] = job;
+            count++;
+        }
+        Job popBack() {
+            count--;
+            return jobs[(first + count) % JOB_QUEUE_SIZE];
+        }
+        Job popFront() {
+            Job job = jobs[first];
+            first = (first + 1) % JOB_QUEUE_SIZE;
+            count--;
+            return job;
+        }
+    };
+
+    void run(int count, int grain, RangeFunction function, const void* context);
+
+    // Runs one job from the own queue or a stolen one, false if there was none
+    bool runOne(int self);
+    void workerLoop(int self);
+
+    std::vector<std::thread> workers;
+    // One per thread, the calling thread's is the first
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{ 0 };
+    bool stopping = false;
+};
@@ -0,0 +1,182 @@
+#include "Menu.hpp"
+
+#include <algorithm>
+
+Button::Button(const sf::Vector2f& position, const sf::Vector2f& size,
+    const std::string& buttonText, const sf::Font& font,
+    std::function<void()> onClick)
+    : callback(onClick), isHovered(false) {
+
+    shape.setPosition(position);
+    shape.setSize(size);
+    shape.setFillColor(sf::Color(100, 100, 100));
+    shape.setOutlineThickness(2);
+    shape.setOutlineColor(sf::Color::White);
+    bounds = shape.getGlobalBounds();
+
+    text.setFont(font);
+    text.setString(buttonText);
+    text.setCharacterSize(20);
+    text.setFillColor(sf::Color::White);
+
+    // Center text
+    sf::FloatRect textBounds = text.getLocalBounds();
+    text.setOrigin(textBounds.left + textBounds.width / 2.0f,
+        textBounds.top + textBounds.height / 2.0f);
+    text.setPosition(
+        position.x + size.x / 2.0f,
+        position.y + size.y / 2.0f
+    );
+}
+
+bool Button::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::MouseMoved) {
+        setHovered(bounds.contains(event.mouseMove.x, event.mouseMove.y));
+    } else if (event.type == sf::Event::MouseButtonPressed &&
+        event.mouseButton.button == sf::Mouse::Left &&
+        bounds.contains(event.mouseButton.x, event.mouseButton.y)) {
+        callback();
+        return true;
+    }
+    return false;
+}
+
+void Button::setHovered(bool hovered) {
+    if (hovered == isHovered) return;
+
+    isHovered = hovered;
+    shape.setFillColor(hovered ? sf::Color(150, 150, 150) : sf::Color(100, 100, 100));
+}
+
+bool Button::contains(const sf::Vector2i& point) const {
+    return bounds.contains(point.x, point.y);
+}
+
+void Button::draw(sf::RenderTarget& target) const {
+    target.draw(shape);
+    target.draw(text);
+}
+
+MenuOverlay::MenuOverlay(const sf::Font& font, const std::string& title, const sf::Vector2f& windowSize,
+    const sf::Color& backdrop)
+    : windowSize(windowSize) {
+    background.setSize(windowSize);
+    background.setFillColor(backdrop);
+
+    titleText.setFont(font);
+    titleText.setCharacterSize(40);
+    titleText.setFillColor(sf::Color::White);
+
+    scoreText.setFont(font);
+    scoreText.setCharacterSize(30);
+    scoreText.setFillColor(sf::Color::White);
+
+    setTitle(title);
+    updateLayer();
+}
+
+void MenuOverlay::addButton(const Button& button) {
+    buttons.push_back(button);
+}
+
+void MenuOverlay::addLabel(const sf::Text& label) {
+    labels.push_back(label);
+    updateLayer();
+}
+
+void MenuOverlay::setTitle(const std::string& text) {
+    if (text == title) return;
+    title = text;
+
+    titleText.setString(title);
+    sf::FloatRect textRect = titleText.getLocalBounds();
+    titleText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
+    titleText.setPosition(windowSize.x / 2.0f, windowSize.y / 2.0f - 150);
+    updateLayer();
+}
+
+void MenuOverlay::setScoreText(const std::string& text) {
+    if (text == score) return;
+    score = text;
+
+    scoreText.setString(score);
+    sf::FloatRect textRect = scoreText.getLocalBounds();
+    scoreText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
+    scoreText.setPosition(windowSize.x / 2.0f, windowSize.y / 2.0f - 80);
+    updateLayer();
+}
+
+void MenuOverlay::handleEvent(const sf::Event& event) {
+    for (auto& button : buttons) {
+        // A click may switch to another menu, this one is done then
+        if (button.handleEvent(event)) return;
+    }
+}
+
+void MenuOverlay::hoverAt(const sf::Vector2i& point) {
+    for (auto& button : buttons) {
+        button.setHovered(button.contains(point));
+    }
+}
+
+void MenuOverlay::updateLayer() {
+    sf::FloatRect area;
+
+    // A backdrop covers the whole window, otherwise only the texts count
+    if (background.getFillColor().a != 0) {
+        area = sf::FloatRect(0, 0, windowSize.x, windowSize.y);
+    } else {
+        bool empty = true;
+        auto include = [&](const sf::FloatRect& bounds) {
+            if (empty) {
+                area = bounds;
+                empty = false;
+                return;
+            }
+            float right = std::max(area.left + area.width, bounds.left + bounds.width);
+            float bottom = std::max(area.top + area.height, bounds.top + bounds.height);
+            area.left = std::min(area.left, bounds.left);
+            area.top = std::min(area.top, bounds.top);
+            area.width = right - area.left;
+            area.height = bottom - area.top;
+        };
+
+        if (!title.empty()) include(titleText.getGlobalBounds());
+        if (!score.empty()) include(scoreText.getGlobalBounds());
+        for (const auto& label : labels) {
+            include(label.getGlobalBounds());
+        }
+
+        // Glyph edges reach a little past the text's bounds
+        if (!empty) {
+            area = sf::FloatRect(area.left - 2, area.top - 2, area.width + 4, area.height + 4);
+        }
+    }
+
+    layer.setArea(area);
+    layer.invalidate();
+}
+
+void MenuOverlay::drawStatic(sf::RenderTarget& target) const {
+    if (background.getFillColor().a != 0) {
+        target.draw(background);
+    }
+    if (!title.empty()) {
+        target.draw(titleText);
+    }
+    if (!score.empty()) {
+        target.draw(scoreText);
+    }
+    for (const auto& label : labels) {
+        target.draw(label);
+    }
+}
+
+void MenuOverlay::draw(sf::RenderTarget& target) {
+    layer.draw(target, [this](sf::RenderTarget& layerTarget) {
+        drawStatic(layerTarget);
+    });
+    for (const auto& button : buttons) {
+        button.draw(target);
+    }
+}
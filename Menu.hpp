@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CachedLayer.hpp"
+
+// Menus are built once per screen and kept. Text layout only happens when
+// a string actually changes, and hover and clicks are tested against the
+// bounds cached at construction, with the mouse position taken from the
+// event itself. Backdrop, title, score and labels only change with those
+// strings, so they are drawn from a CachedLayer.
+
+class Button {
+private:
+    sf::RectangleShape shape;
+    sf::Text text;
+    sf::FloatRect bounds;
+    std::function<void()> callback;
+    bool isHovered;
+
+public:
+    Button(const sf::Vector2f& position, const sf::Vector2f& size,
+        const std::string& buttonText, const sf::Font& font,
+        std::function<void()> onClick);
+
+    // True if the event clicked the button
+    bool handleEvent(const sf::Event& event);
+
+    void setHovered(bool hovered);
+    bool contains(const sf::Vector2i& point) const;
+
+    void draw(sf::RenderTarget& target) const;
+};
+
+class MenuOverlay {
+private:
+    sf::Vector2f windowSize;
+
+    sf::RectangleShape background;
+    std::vector<Button> buttons;
+    std::vector<sf::Text> labels;
+    sf::Text titleText;
+    sf::Text scoreText;
+
+    std::string title;
+    std::string score;
+
+    CachedLayer layer;
+
+    void drawStatic(sf::RenderTarget& target) const;
+    // Called whenever a static part changed
+    void updateLayer();
+
+public:
+    // A transparent backdrop is not drawn at all
+    MenuOverlay(const sf::Font& font, const std::string& title, const sf::Vector2f& windowSize,
+        const sf::Color& backdrop = sf::Color(0, 0, 0, 180));
+
+    void addButton(const Button& button);
+    void addLabel(const sf::Text& label);
+
+    // Both only lay the text out again when it changed
+    void setTitle(const std::string& text);
+    void setScoreText(const std::string& text);
+
+    void handleEvent(const sf::Event& event);
+
+    // Highlights whatever is under the point, for when the overlay is
+    // shown again and no mouse event has come in yet
+    void hoverAt(const sf::Vector2i& point);
+
+    void draw(sf::RenderTarget& target);
+};
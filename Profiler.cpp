@@ -0,0 +1,144 @@
+#include "Profiler.hpp"
+
+#include "AllocationTracker.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const char* const PHASE_NAMES[PHASE_COUNT + 1] = {
+    "input",
+    "player",
+    "ship hits",
+    "player house hits",
+    "shooters",
+    "fleet",
+    "ship bullets",
+    "ship house hits",
+    "player hits",
+    "hud",
+    "draw",
+    "menus",
+    "display",
+    "total",
+};
+
+}
+
+const char* phaseName(int phase) {
+    return PHASE_NAMES[phase];
+}
+
+Profiler& profiler() {
+    thread_local Profiler instance;
+    return instance;
+}
+
+bool Profiler::openCsv(const std::string& path) {
+    csv.open(path, std::ios::trunc);
+    if (!csv.is_open()) return false;
+
+    csv << "frame";
+    for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+        csv << ',' << phaseName(phase);
+    }
+    if (ALLOCATION_TRACKING) {
+        for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+            csv << ',' << phaseName(phase) << " allocs";
+        }
+    }
+    csv << '\n';
+    return true;
+}
+
+void Profiler::beginFrame() {
+    // Turning the profiler on or off takes effect from the next frame
+    frameOpen = enabled;
+    openPhase = -1;
+    std::fill(std::begin(current), std::end(current), 0);
+    if (frameOpen) frameStart = std::chrono::steady_clock::now();
+
+    setAllocationPhase(-1);
+    if (frameOpen && ALLOCATION_TRACKING) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            currentAllocations[phase] = threadAllocations(phase);
+        }
+        currentAllocations[FRAME_TOTAL] = threadAllocationTotal();
+    }
+}
+
+int Profiler::switchTo(int phase) {
+    auto now = std::chrono::steady_clock::now();
+    if (openPhase != -1) {
+        current[openPhase] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - phaseStart).count();
+    }
+
+    int previous = openPhase;
+    openPhase = phase;
+    phaseStart = now;
+    setAllocationPhase(phase);
+    return previous;
+}
+
+void Profiler::endFrame() {
+    if (!frameOpen) return;
+    frameOpen = false;
+
+    current[FRAME_TOTAL] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - frameStart).count();
+
+    setAllocationPhase(-1);
+    if (ALLOCATION_TRACKING) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            currentAllocations[phase] = threadAllocations(phase) - currentAllocations[phase];
+        }
+        currentAllocations[FRAME_TOTAL] = threadAllocationTotal() - currentAllocations[FRAME_TOTAL];
+    }
+
+    uint32_t frame = frames.load(std::memory_order_relaxed);
+    auto& slot = history[frame % FRAME_HISTORY];
+    for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+        slot[phase].store(static_cast<uint32_t>(std::min<uint64_t>(current[phase], UINT32_MAX)), std::memory_order_relaxed);
+        allocationHistory[frame % FRAME_HISTORY][phase].store(
+            static_cast<uint32_t>(std::min<uint64_t>(currentAllocations[phase], UINT32_MAX)), std::memory_order_relaxed);
+    }
+    frames.store(frame + 1, std::memory_order_release);
+
+    if (csv.is_open()) {
+        // Microseconds, plenty of precision for comparing builds
+        csv << frame;
+        for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+            csv << ',' << current[phase] / 1000.0;
+        }
+        if (ALLOCATION_TRACKING) {
+            for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+                csv << ',' << currentAllocations[phase];
+            }
+        }
+        csv << '\n';
+    }
+}
+
+PhaseStats Profiler::stats(int phase) const {
+    // The oldest slot is left out, it is the next one to be overwritten
+    uint32_t published = frameCount();
+    uint32_t count = std::min<uint32_t>(published, FRAME_HISTORY - 1);
+
+    PhaseStats result;
+    if (count == 0) return result;
+
+    std::vector<uint32_t> values(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t frame = published - 1 - i;
+        values[i] = history[frame % FRAME_HISTORY][phase].load(std::memory_order_relaxed);
+        result.maxAllocations = std::max(result.maxAllocations,
+            allocationHistory[frame % FRAME_HISTORY][phase].load(std::memory_order_relaxed));
+    }
+
+    std::sort(values.begin(), values.end());
+    result.p50 = values[count / 2] / 1000.f;
+    result.p99 = values[std::min<uint32_t>(count - 1, count * 99 / 100)] / 1000.f;
+    result.max = values[count - 1] / 1000.f;
+    return result;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+enum ProfilePhase {
+    PHASE_INPUT,
+    PHASE_PLAYER,
+    PHASE_SHIP_HITS,
+    PHASE_PLAYER_HOUSE_HITS,
+    PHASE_SHOOTERS,
+    PHASE_FLEET,
+    PHASE_SHIP_BULLETS,
+    PHASE_SHIP_HOUSE_HITS,
+    PHASE_PLAYER_HITS,
+    PHASE_HUD,
+    PHASE_DRAW,
+    PHASE_MENUS,
+    PHASE_DISPLAY,
+    PHASE_COUNT,
+};
+
+const char* phaseName(int phase);
+
+struct PhaseStats {
+    // Microseconds over the frames in the history
+    float p50 = 0.f;
+    float p99 = 0.f;
+    float max = 0.f;
+    // Most heap allocations in one frame, see AllocationTracker.hpp
+    uint32_t maxAllocations = 0;
+};
+
+// Times the phases of every frame. The game thread adds to the current
+// frame and publishes it into a ring of the last FRAME_HISTORY frames in
+// endFrame(). Readers only look at published frames, so the ring can be
+// read from another thread without a lock.
+class Profiler {
+public:
+    static const int FRAME_HISTORY = 512;
+    // Slot after the phases that holds the whole frame
+    static const int FRAME_TOTAL = PHASE_COUNT;
+
+    // Nothing is timed while disabled, a scope then costs one branch
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Every frame is also written to this file as one CSV row
+    bool openCsv(const std::string& path);
+
+    void beginFrame();
+    void endFrame();
+
+    // Charges the time since the last switch to the open phase and opens
+    // the given one instead (-1 for none). Returns the phase that was open.
+    int switchTo(int phase);
+
+    uint32_t frameCount() const { return frames.load(std::memory_order_acquire); }
+
+    // Nanoseconds the phase took in the frame that was ended last
+    uint64_t lastFrame(int phase) const { return current[phase]; }
+    // Heap allocations made in the phase in the frame that was ended last
+    uint64_t lastFrameAllocations(int phase) const { return currentAllocations[phase]; }
+
+    // Percentiles of one phase (or FRAME_TOTAL) over the published history
+    PhaseStats stats(int phase) const;
+
+private:
+    std::atomic<bool> enabled{ false };
+    bool frameOpen = false;
+
+    uint64_t current[PHASE_COUNT + 1] = {};
+    std::chrono::steady_clock::time_point frameStart;
+
+    // The thread's allocation counts when the frame began, then the
+    // allocations during it. The total slot counts the whole frame.
+    uint64_t currentAllocations[PHASE_COUNT + 1] = {};
+
+    int openPhase = -1;
+    std::chrono::steady_clock::time_point phaseStart;
+
+    // Nanoseconds, capped at about 4 seconds per phase
+    std::atomic<uint32_t> history[FRAME_HISTORY][PHASE_COUNT + 1] = {};
+    std::atomic<uint32_t> allocationHistory[FRAME_HISTORY][PHASE_COUNT + 1] = {};
+    std::atomic<uint32_t> frames{ 0 };
+
+    std::ofstream csv;
+};
+
+// The calling thread's profiler. Each thread that runs phases has its own,
+// others can still read its published history.
+Profiler& profiler();
+
+// Times from construction to destruction into a phase. A scope opened
+// inside another one pauses it, so every phase only counts its own time.
+// next() moves on to another phase, so a function split into phases needs
+// one scope instead of a block per phase.
+class ProfileScope {
+public:
+    explicit ProfileScope(int phase)
+        : active(profiler().isEnabled()) {
+        if (active) outer = profiler().switchTo(phase);
+    }
+
+    ~ProfileScope() {
+        if (active) profiler().switchTo(outer);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    void next(int phase) {
+        if (active) profiler().switchTo(phase);
+    }
+
+private:
+    bool active;
+    int outer = -1;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// Small random generator (xorshift64*) whose whole state is one number,
+// so it can be stored in a save file and restored exactly
+class Random {
+public:
+    explicit Random(uint64_t seed = 0x9E3779B97F4A7C15ull) {
+        setState(seed);
+    }
+
+    // Start a new sequence. Similar seeds (1, 2, 3...) are spread out first
+    // so they do not give similar sequences.
+    void seed(uint64_t value) {
+        uint64_t z = value + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        setState(z ^ (z >> 31));
+    }
+
+    uint64_t getState() const { return state; }
+
+    void setState(uint64_t newState) {
+        // xorshift gets stuck on zero
+        state = newState != 0 ? newState : 0x9E3779B97F4A7C15ull;
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform-ish integer in [0, bound)
+    int nextInt(int bound) {
+        return static_cast<int>((next() >> 33) % static_cast<uint64_t>(bound));
+    }
+
+private:
+    uint64_t state;
+};
@@ -0,0 +1,33 @@
+#include "RenderSnapshot.hpp"
+
+void takeSnapshot(const Simulation& sim, RenderSnapshot& snapshot) {
+    snapshot.takenAt = std::chrono::steady_clock::now();
+
+    snapshot.fleetOrigin = sim.fleetOrigin();
+    snapshot.ships.clear();
+    for (int shipId = 0; shipId < sim.ships.size(); shipId++) {
+        snapshot.ships.push_back({ sim.ships.position[shipId], sim.ships.tint[shipId] });
+    }
+
+    snapshot.houses.clear();
+    for (int houseId = 0; houseId < sim.houses.size(); houseId++) {
+        snapshot.houses.push_back({ sim.houses.position[houseId], sim.houses.tint[houseId] });
+    }
+
+    snapshot.bullets.clear();
+    for (int bulletId = 0; bulletId < sim.bullets.size(); bulletId++) {
+        snapshot.bullets.push_back({
+            sf::Vector2f(sim.bullets.x[bulletId], sim.bullets.y[bulletId]),
+            sf::Vector2f(sim.bullets.vx[bulletId], sim.bullets.vy[bulletId]),
+            sim.bullets.owner[bulletId] == BulletOwner::Player
+        });
+    }
+
+    snapshot.player = { sim.player.getShape().getPosition(), sim.player.getShape().getFillColor() };
+
+    snapshot.score = sim.score;
+    snapshot.round = sim.round;
+    snapshot.totalLives = sim.player.getTotalLives();
+    snapshot.isGameOver = sim.isGameOver;
+    snapshot.roundCleared = sim.ships.empty();
+}
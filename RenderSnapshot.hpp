@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Simulation.hpp"
+
+struct ShapeSprite {
+    sf::Vector2f position;
+    sf::Color color;
+};
+
+struct BulletSprite {
+    sf::Vector2f position;
+    sf::Vector2f velocity;
+    bool isPlayers;
+};
+
+// Everything the window needs to draw one tick, copied out of the
+// simulation so it can be drawn while the next tick runs. Positions of the
+// tick before are kept too, so frames between two ticks can be blended.
+struct RenderSnapshot {
+    uint64_t tick = 0;
+    // Commands from the UI the simulation had finished when this was taken
+    uint64_t commandsDone = 0;
+    // Number of the newest Load command that failed, 0 if none did
+    uint64_t failedLoad = 0;
+    std::chrono::steady_clock::time_point takenAt;
+    // Seconds the simulation already was into the next tick when this was taken
+    float lag = 0;
+
+    sf::Vector2f fleetOrigin;
+    sf::Vector2f previousFleetOrigin;
+    // Ship positions are relative to the fleet origin
+    std::vector<ShapeSprite> ships;
+    std::vector<ShapeSprite> houses;
+    std::vector<BulletSprite> bullets;
+
+    ShapeSprite player;
+    sf::Vector2f previousPlayerPosition;
+
+    int score = 0;
+    int round = 1;
+    int totalLives = 0;
+    bool isGameOver = false;
+    bool roundCleared = false;
+};
+
+// Fills the snapshot from the simulation. The vectors keep their storage,
+// so taking a snapshot every tick does not allocate.
+void takeSnapshot(const Simulation& sim, RenderSnapshot& snapshot);
@@ -0,0 +1,270 @@
+#include "Replay.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const char REPLAY_MAGIC[4] = { 'P', 'P', 'P', 'R' };
+const size_t HEADER_SIZE = 40;
+const size_t KEYFRAME_SIZE = 16;
+
+const uint8_t MOVE_RIGHT = 1;
+const uint8_t MOVE_LEFT = 2;
+const uint8_t SHOOT = 4;
+const uint8_t HAS_DT = 8;
+const uint8_t COMMAND = 0x80;
+
+template <typename T>
+void putAt(std::vector<char>& buffer, size_t offset, T value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T getAt(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+}
+
+ReplayRecorder::ReplayRecorder(uint32_t keyframeInterval)
+    : interval(std::max<uint32_t>(keyframeInterval, 1)) {
+}
+
+void ReplayRecorder::begin(const Simulation& sim) {
+    ticks = 0;
+    config = sim.config;
+    stream.clear();
+    keyframes.clear();
+    addKeyframe(sim);
+}
+
+void ReplayRecorder::addKeyframe(const Simulation& sim) {
+    keyframes.push_back({ ticks, static_cast<uint32_t>(stream.size()), sim.saveSnapshot() });
+    dtKnown = false;
+}
+
+void ReplayRecorder::recordStep(const Simulation& sim, const InputFrame& input, float dt) {
+    if (ticks > 0 && ticks % interval == 0) {
+        addKeyframe(sim);
+    }
+
+    uint8_t record = 0;
+    if (input.moveDir > 0) record |= MOVE_RIGHT;
+    if (input.moveDir < 0) record |= MOVE_LEFT;
+    if (input.shoot) record |= SHOOT;
+
+    // Compared bit for bit, playback has to get the exact same float
+    bool newDt = !dtKnown || std::memcmp(&dt, &lastDt, sizeof(float)) != 0;
+    if (newDt) record |= HAS_DT;
+
+    put<uint8_t>(record);
+    if (newDt) {
+        put<float>(dt);
+        lastDt = dt;
+        dtKnown = true;
+    }
+
+    ticks++;
+}
+
+void ReplayRecorder::recordRestart(uint64_t seed) {
+    put<uint8_t>(REPLAY_RESTART);
+    put<uint64_t>(seed);
+}
+
+void ReplayRecorder::recordClearFleet() {
+    put<uint8_t>(REPLAY_CLEAR_FLEET);
+}
+
+void ReplayRecorder::recordNextRound() {
+    put<uint8_t>(REPLAY_NEXT_ROUND);
+}
+
+void ReplayRecorder::recordLoad(const Simulation& sim) {
+    std::vector<char> snapshot = sim.saveSnapshot();
+    put<uint8_t>(REPLAY_LOAD);
+    put<uint32_t>(snapshot.size());
+    stream.insert(stream.end(), snapshot.begin(), snapshot.end());
+}
+
+std::vector<char> ReplayRecorder::finish() const {
+    size_t indexStart = HEADER_SIZE;
+    size_t streamStart = indexStart + keyframes.size() * KEYFRAME_SIZE;
+    size_t snapshotStart = streamStart + stream.size();
+
+    size_t total = snapshotStart;
+    for (const auto& keyframe : keyframes) {
+        total += keyframe.snapshot.size();
+    }
+
+    std::vector<char> out(total);
+
+    std::memcpy(out.data(), REPLAY_MAGIC, 4);
+    putAt<uint16_t>(out, 4, REPLAY_VERSION);
+    putAt<uint16_t>(out, 6, 0);
+    putAt<uint32_t>(out, 8, static_cast<uint32_t>(total));
+    putAt<uint32_t>(out, 16, ticks);
+    putAt<uint32_t>(out, 20, interval);
+    putAt<uint32_t>(out, 24, static_cast<uint32_t>(keyframes.size()));
+    putAt<uint32_t>(out, 28, static_cast<uint32_t>(stream.size()));
+    putAt<int32_t>(out, 32, config.maxPlayerBullets);
+    putAt<int32_t>(out, 36, config.maxShipBullets);
+
+    size_t snapshotOffset = snapshotStart;
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        size_t entry = indexStart + i * KEYFRAME_SIZE;
+        const Keyframe& keyframe = keyframes[i];
+
+        putAt<uint32_t>(out, entry, keyframe.tick);
+        putAt<uint32_t>(out, entry + 4, keyframe.streamOffset);
+        putAt<uint32_t>(out, entry + 8, static_cast<uint32_t>(snapshotOffset));
+        putAt<uint32_t>(out, entry + 12, static_cast<uint32_t>(keyframe.snapshot.size()));
+
+        std::memcpy(out.data() + snapshotOffset, keyframe.snapshot.data(), keyframe.snapshot.size());
+        snapshotOffset += keyframe.snapshot.size();
+    }
+
+    if (!stream.empty()) {
+        std::memcpy(out.data() + streamStart, stream.data(), stream.size());
+    }
+
+    putAt<uint32_t>(out, 12, crc32(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE));
+    return out;
+}
+
+bool ReplayPlayer::open(const std::string& path) {
+    keyframes.clear();
+    stream = nullptr;
+    streamSize = 0;
+    position = 0;
+    ticks = 0;
+    currentTick = 0;
+
+    if (!file.open(path)) return false;
+
+    const char* data = file.data();
+    size_t size = file.size();
+
+    if (size < HEADER_SIZE) return false;
+    if (std::memcmp(data, REPLAY_MAGIC, 4) != 0) return false;
+    if (getAt<uint16_t>(data, 4) != REPLAY_VERSION) return false;
+    if (getAt<uint32_t>(data, 8) != size) return false;
+
+    uint32_t keyframeCount = getAt<uint32_t>(data, 24);
+    uint32_t newStreamSize = getAt<uint32_t>(data, 28);
+
+    size_t streamStart = HEADER_SIZE + static_cast<size_t>(keyframeCount) * KEYFRAME_SIZE;
+    if (keyframeCount == 0 || streamStart > size || newStreamSize > size - streamStart) return false;
+
+    if (getAt<uint32_t>(data, 12) != crc32(data + HEADER_SIZE, size - HEADER_SIZE)) return false;
+
+    int32_t playerBullets = getAt<int32_t>(data, 32);
+    int32_t shipBullets = getAt<int32_t>(data, 36);
+    if (playerBullets <= 0 || shipBullets <= 0 || playerBullets > MAX_BULLETS || shipBullets > MAX_BULLETS) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < keyframeCount; i++) {
+        size_t entry = HEADER_SIZE + i * KEYFRAME_SIZE;
+        Keyframe keyframe = {
+            getAt<uint32_t>(data, entry),
+            getAt<uint32_t>(data, entry + 4),
+            getAt<uint32_t>(data, entry + 8),
+            getAt<uint32_t>(data, entry + 12),
+        };
+
+        if (keyframe.streamOffset > newStreamSize ||
+            keyframe.snapshotOffset > size || keyframe.snapshotSize > size - keyframe.snapshotOffset) {
+            return false;
+        }
+        // seek() relies on the index being in tick order
+        if (!keyframes.empty() && keyframe.tick < keyframes.back().tick) return false;
+
+        keyframes.push_back(keyframe);
+    }
+
+    config.maxPlayerBullets = playerBullets;
+    config.maxShipBullets = shipBullets;
+
+    ticks = getAt<uint32_t>(data, 16);
+    stream = data + streamStart;
+    streamSize = newStreamSize;
+    return true;
+}
+
+bool ReplayPlayer::seek(Simulation& sim, uint32_t tick) {
+    if (keyframes.empty()) return false;
+
+    tick = std::min(tick, ticks);
+
+    // Last keyframe at or before the tick
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+        [](uint32_t value, const Keyframe& keyframe) { return value < keyframe.tick; });
+    const Keyframe& keyframe = *(next == keyframes.begin() ? next : next - 1);
+
+    sim.setConfig(config);
+    if (!sim.loadSnapshot(file.data() + keyframe.snapshotOffset, keyframe.snapshotSize)) {
+        return false;
+    }
+
+    position = keyframe.streamOffset;
+    currentTick = keyframe.tick;
+    if (!applyCommands(sim)) return false;
+
+    while (currentTick < tick) {
+        if (!advance(sim)) return false;
+    }
+    return true;
+}
+
+bool ReplayPlayer::advance(Simulation& sim) {
+    uint8_t record;
+    if (!get(record) || (record & COMMAND)) return false;
+
+    if (record & HAS_DT) {
+        if (!get(dt)) return false;
+    }
+
+    InputFrame input;
+    input.moveDir = (record & MOVE_RIGHT ? 1 : 0) - (record & MOVE_LEFT ? 1 : 0);
+    input.shoot = (record & SHOOT) != 0;
+
+    sim.step(input, dt);
+    currentTick++;
+
+    return applyCommands(sim);
+}
+
+bool ReplayPlayer::applyCommands(Simulation& sim) {
+    while (position < streamSize && (stream[position] & COMMAND)) {
+        uint8_t command = 0;
+        get(command);
+
+        switch (command) {
+        case REPLAY_RESTART: {
+            uint64_t seed;
+            if (!get(seed)) return false;
+            sim.make(seed);
+            break;
+        }
+        case REPLAY_CLEAR_FLEET:
+            sim.clearFleet();
+            break;
+        case REPLAY_NEXT_ROUND:
+            sim.nextRound();
+            break;
+        case REPLAY_LOAD: {
+            uint32_t size;
+            if (!get(size) || size > streamSize - position) return false;
+            if (!sim.loadSnapshot(stream + position, size)) return false;
+            position += size;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SaveFile.hpp"
+#include "Simulation.hpp"
+
+// Replay file
+//
+//   header     "PPPR", u16 version, u16 unused, u32 total size, u32 crc,
+//              u32 tick count, u32 keyframe interval, u32 keyframe count,
+//              u32 stream size, i32 max player bullets, i32 max ship bullets
+//   index      per keyframe: u32 tick, u32 stream offset,
+//              u32 snapshot offset from file start, u32 snapshot size
+//   stream     one record per tick and per command, see below
+//   snapshots  the keyframes as save game snapshots, back to back
+//
+// A tick record is a single byte: bits 0-1 move direction (1 right, 2 left),
+// bit 2 shoot, bit 3 a float dt follows. The dt is only written when it
+// changes, so at a steady frame rate a tick costs one byte. Bytes with the
+// top bit set are commands that change the game outside of step().
+//
+// The CRC32 covers everything after the header. Keyframe 0 is the state the
+// recording started from, the others are taken every keyframe interval
+// ticks so seeking only re-simulates from the closest one.
+
+const uint16_t REPLAY_VERSION = 4;
+
+enum ReplayCommand : uint8_t {
+    REPLAY_RESTART = 0x80,      // u64 seed follows
+    REPLAY_CLEAR_FLEET = 0x81,
+    REPLAY_NEXT_ROUND = 0x82,
+    REPLAY_LOAD = 0x83,         // u32 size and a snapshot follow
+};
+
+class ReplayRecorder {
+public:
+    ReplayRecorder() = default;
+    explicit ReplayRecorder(uint32_t keyframeInterval);
+
+    // Starts a new recording from the simulation's current state
+    void begin(const Simulation& sim);
+
+    // Call right before sim.step() with the same input and dt
+    void recordStep(const Simulation& sim, const InputFrame& input, float dt);
+
+    void recordRestart(uint64_t seed);
+    void recordClearFleet();
+    void recordNextRound();
+    // Call after the simulation loaded a save game
+    void recordLoad(const Simulation& sim);
+
+    uint32_t tickCount() const { return ticks; }
+
+    std::vector<char> finish() const;
+
+private:
+    struct Keyframe {
+        uint32_t tick;
+        uint32_t streamOffset;
+        std::vector<char> snapshot;
+    };
+
+    void addKeyframe(const Simulation& sim);
+
+    template <typename T>
+    void put(T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        stream.insert(stream.end(), bytes, bytes + sizeof(T));
+    }
+
+    uint32_t interval = 600;
+    uint32_t ticks = 0;
+    SimConfig config;
+    std::vector<char> stream;
+    std::vector<Keyframe> keyframes;
+
+    // Forces the dt to be written on the first tick after a keyframe, so
+    // playback can start at any keyframe
+    bool dtKnown = false;
+    float lastDt = 0.f;
+};
+
+// Plays a replay file back into a simulation
+class ReplayPlayer {
+public:
+    // False if the file is missing or anything in it does not check out
+    bool open(const std::string& path);
+
+    // Puts the simulation at the given tick (clamped to the end), starting
+    // from the closest keyframe before it
+    bool seek(Simulation& sim, uint32_t tick);
+
+    // Runs one tick and the commands up to the next one.
+    // False at the end of the replay or on a broken record.
+    bool advance(Simulation& sim);
+
+    uint32_t tick() const { return currentTick; }
+    uint32_t tickCount() const { return ticks; }
+    bool atEnd() const { return position >= streamSize; }
+
+private:
+    struct Keyframe {
+        uint32_t tick;
+        uint32_t streamOffset;
+        uint32_t snapshotOffset;
+        uint32_t snapshotSize;
+    };
+
+    // Applies commands until the next tick record
+    bool applyCommands(Simulation& sim);
+
+    template <typename T>
+    bool get(T& value) {
+        if (position + sizeof(T) > streamSize) return false;
+        std::memcpy(&value, stream + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    MappedFile file;
+    std::vector<Keyframe> keyframes;
+    SimConfig config;
+    const char* stream = nullptr;
+    size_t streamSize = 0;
+    size_t position = 0;
+
+    uint32_t ticks = 0;
+    uint32_t currentTick = 0;
+    float dt = FIXED_DT;
+};
@@ -0,0 +1,241 @@
+#include "SaveFile.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char SAVE_MAGIC[4] = { 'P', 'P', 'P', 'S' };
+const size_t HEADER_SIZE = 16;
+const size_t ENTRY_SIZE = 12;
+
+template <typename T>
+void putAt(std::vector<char>& buffer, size_t offset, T value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T getAt(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+struct CrcTable {
+    uint32_t values[256];
+
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            values[i] = c;
+        }
+    }
+};
+
+}
+
+uint32_t crc32(const char* data, size_t size) {
+    static const CrcTable table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.values[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+SnapshotWriter::SnapshotWriter() {
+    payload.reserve(4096);
+}
+
+void SnapshotWriter::beginSection(uint32_t id) {
+    sections.push_back({ id, static_cast<uint32_t>(payload.size()) });
+}
+
+std::vector<char> SnapshotWriter::finish() {
+    size_t tableSize = sections.size() * ENTRY_SIZE;
+    size_t payloadStart = HEADER_SIZE + tableSize;
+
+    std::vector<char> out(payloadStart + payload.size());
+
+    std::memcpy(out.data(), SAVE_MAGIC, 4);
+    putAt<uint16_t>(out, 4, SAVE_VERSION);
+    putAt<uint16_t>(out, 6, static_cast<uint16_t>(sections.size()));
+    putAt<uint32_t>(out, 12, static_cast<uint32_t>(out.size()));
+
+    for (size_t i = 0; i < sections.size(); i++) {
+        uint32_t end = i + 1 < sections.size() ? sections[i + 1].start : static_cast<uint32_t>(payload.size());
+        size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+
+        putAt<uint32_t>(out, entry, sections[i].id);
+        putAt<uint32_t>(out, entry + 4, static_cast<uint32_t>(payloadStart + sections[i].start));
+        putAt<uint32_t>(out, entry + 8, end - sections[i].start);
+    }
+
+    if (!payload.empty()) {
+        std::memcpy(out.data() + payloadStart, payload.data(), payload.size());
+    }
+
+    putAt<uint32_t>(out, 8, crc32(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE));
+    return out;
+}
+
+bool SnapshotReader::open(const char* newData, size_t newSize) {
+    data = nullptr;
+    size = 0;
+    sectionCount = 0;
+
+    if (newData == nullptr || newSize < HEADER_SIZE) return false;
+    if (std::memcmp(newData, SAVE_MAGIC, 4) != 0) return false;
+    if (getAt<uint16_t>(newData, 4) != SAVE_VERSION) return false;
+
+    // A truncated or padded file is rejected before anything is read from it
+    if (getAt<uint32_t>(newData, 12) != newSize) return false;
+
+    uint16_t count = getAt<uint16_t>(newData, 6);
+    if (HEADER_SIZE + count * ENTRY_SIZE > newSize) return false;
+
+    for (uint16_t i = 0; i < count; i++) {
+        size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+        uint32_t offset = getAt<uint32_t>(newData, entry + 4);
+        uint32_t length = getAt<uint32_t>(newData, entry + 8);
+
+        if (offset < HEADER_SIZE + count * ENTRY_SIZE || offset > newSize || length > newSize - offset) {
+            return false;
+        }
+    }
+
+    if (getAt<uint32_t>(newData, 8) != crc32(newData + HEADER_SIZE, newSize - HEADER_SIZE)) {
+        return false;
+    }
+
+    data = newData;
+    size = newSize;
+    sectionCount = count;
+    return true;
+}
+
+bool SnapshotReader::section(uint32_t id, SectionView& view) const {
+    for (uint16_t i = 0; i < sectionCount; i++) {
+        size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+        if (getAt<uint32_t>(data, entry) == id) {
+            view = SectionView(data + getAt<uint32_t>(data, entry + 4), getAt<uint32_t>(data, entry + 8));
+            return true;
+        }
+    }
+    return false;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    bytes = static_cast<const char*>(mapped);
+    length = info.st_size;
+    return true;
+#else
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open()) return false;
+
+    fallback.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+    if (fallback.empty()) return false;
+
+    bytes = fallback.data();
+    length = fallback.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (bytes != nullptr) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+#else
+    fallback.clear();
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+bool writeFileAtomic(const std::string& path, const std::vector<char>& bytes) {
+    std::string tempPath = path + ".tmp";
+
+#ifndef _WIN32
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return false;
+
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t result = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (result < 0) {
+            ::close(fd);
+            ::unlink(tempPath.c_str());
+            return false;
+        }
+        written += result;
+    }
+
+    if (::fsync(fd) != 0) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+
+    // Make the rename itself survive a power cut
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd != -1) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+#else
+    {
+        std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open()) return false;
+
+        outFile.write(bytes.data(), bytes.size());
+        outFile.flush();
+        if (!outFile) return false;
+    }
+
+    // rename() does not replace an existing file on Windows
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
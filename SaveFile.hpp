@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Binary snapshot container
+//
+//   header   "PPPS", u16 version, u16 section count, u32 crc, u32 total size
+//   table    per section: u32 id, u32 offset from file start, u32 size
+//   payload  the sections back to back
+//
+// The CRC32 covers everything after the header. Numbers are written field
+// by field in native byte order (little endian on every platform the game
+// builds for), so the layout does not depend on struct padding.
+
+const uint16_t SAVE_VERSION = 3;
+
+enum SaveSection : uint32_t {
+    SECTION_META = 1,
+    SECTION_PLAYER = 2,
+    SECTION_HOUSES = 3,
+    SECTION_FLEET = 4,
+    SECTION_BULLETS = 5,
+    SECTION_TIMERS = 6,
+};
+
+uint32_t crc32(const char* data, size_t size);
+
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+
+    // Everything put() after this goes into the section
+    void beginSection(uint32_t id);
+
+    template <typename T>
+    void put(T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        payload.insert(payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    // Header, section table and payload as one buffer
+    std::vector<char> finish();
+
+private:
+    struct Entry {
+        uint32_t id;
+        uint32_t start;
+    };
+
+    std::vector<Entry> sections;
+    std::vector<char> payload;
+};
+
+// Bounds checked cursor over one section of a snapshot
+class SectionView {
+public:
+    SectionView() : data(nullptr), size(0), offset(0) {}
+    SectionView(const char* data, size_t size) : data(data), size(size), offset(0) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (offset + sizeof(T) > size) return false;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    size_t remaining() const { return size - offset; }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset;
+};
+
+// Checks a snapshot and hands out its sections. Nothing is copied, the
+// sections point straight into the given memory.
+class SnapshotReader {
+public:
+    // False if the magic, version, sizes, section table or CRC are wrong
+    bool open(const char* data, size_t size);
+
+    // False if the snapshot has no such section
+    bool section(uint32_t id, SectionView& view) const;
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    uint16_t sectionCount = 0;
+};
+
+// Read-only view of a whole file. Uses mmap where available so loading
+// does not copy the file into a buffer first.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    std::vector<char> fallback;
+};
+
+// Writes the buffer to path.tmp, flushes it to disk and renames it over
+// path, so a crash at any point leaves either the old or the new file
+bool writeFileAtomic(const std::string& path, const std::vector<char>& bytes);
@@ -0,0 +1,63 @@
+#include "SaveService.hpp"
+
+#include "SaveFile.hpp"
+
+SaveService::SaveService() {
+    worker = std::thread(&SaveService::run, this);
+}
+
+SaveService::~SaveService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+
+    // Saves that were already requested still get written
+    worker.join();
+}
+
+void SaveService::requestSave(const std::string& path, std::vector<char> snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Only the newest snapshot for a file matters
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            if (it->path == path) {
+                it = jobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        jobs.push_back({ path, std::move(snapshot) });
+        currentStatus = SaveStatus::Saving;
+    }
+    wake.notify_one();
+}
+
+void SaveService::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (jobs.empty()) return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        bool ok = writeFileAtomic(job.path, job.bytes);
+
+        // The newest finished job decides, so an old failure does not stick
+        // around after a later save went through
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ok) {
+            currentStatus = SaveStatus::Failed;
+        } else {
+            currentStatus = jobs.empty() ? SaveStatus::Saved : SaveStatus::Saving;
+        }
+    }
+}
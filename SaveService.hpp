@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class SaveStatus {
+    Idle,
+    Saving,
+    Saved,
+    Failed,
+};
+
+// Writes save snapshots on a background thread so the frame that asked for
+// the save never waits on the disk. The caller hands over a finished
+// snapshot (Simulation::saveSnapshot()), which the service owns from then on.
+class SaveService {
+public:
+    SaveService();
+    ~SaveService();
+
+    SaveService(const SaveService&) = delete;
+    SaveService& operator=(const SaveService&) = delete;
+
+    void requestSave(const std::string& path, std::vector<char> snapshot);
+
+    // Outcome of the most recently finished save, Saving while more are
+    // queued. Safe to poll every frame.
+    SaveStatus status() const { return currentStatus.load(); }
+
+private:
+    struct Job {
+        std::string path;
+        std::vector<char> bytes;
+    };
+
+    void run();
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    bool stopping = false;
+
+    std::atomic<SaveStatus> currentStatus{ SaveStatus::Idle };
+};
@@ -0,0 +1,168 @@
+#include "SimThread.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+SimThread::SimThread(const SimConfig& config, SaveService& saves, std::function<InputFrame()> readInput)
+    : saves(saves), readInput(readInput) {
+    sim.setConfig(config);
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::startRecording() {
+    replay.begin(sim);
+    recording = true;
+}
+
+void SimThread::profileTo(const std::string& csvPath) {
+    profilePath = csvPath;
+    profiling = true;
+}
+
+void SimThread::start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+uint64_t SimThread::send(SimCommand command) {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commands.push_back(std::move(command));
+    return ++sent;
+}
+
+const RenderSnapshot& SimThread::snapshot() {
+    snapshots.update();
+    return snapshots.front();
+}
+
+void SimThread::run() {
+    // The profiler belongs to the thread that uses it
+    Profiler& ticks = profiler();
+    if (!profilePath.empty() && !ticks.openCsv(profilePath)) {
+        std::cerr << "Could not write " << profilePath << std::endl;
+    }
+    threadProfiler = &ticks;
+
+    auto duration = std::chrono::duration_cast<FramePacer::Clock::duration>(std::chrono::duration<float>(FIXED_DT));
+    FramePacer pacer(0);
+
+    // Real time not yet turned into ticks
+    FramePacer::Clock::duration behind = FramePacer::Clock::duration::zero();
+    auto lastWake = FramePacer::Clock::now();
+
+    while (!stopping) {
+        auto now = FramePacer::Clock::now();
+        behind += now - lastWake;
+        lastWake = now;
+
+        ticks.setEnabled(profiling);
+        ticks.beginFrame();
+
+        applyCommands();
+
+        if (running && !sim.isGameOver && !sim.ships.empty()) {
+            // A stall is made up for with at most a few extra ticks, the
+            // rest of it is dropped so the game never falls further behind
+            behind = std::min(behind, duration * MAX_CATCH_UP_TICKS);
+
+            while (behind >= duration && !sim.isGameOver && !sim.ships.empty()) {
+                previousFleetOrigin = sim.fleetOrigin();
+                previousPlayerPosition = sim.player.getShape().getPosition();
+
+                InputFrame input;
+                {
+                    ProfileScope scope(PHASE_INPUT);
+                    if (focused) input = readInput();
+                }
+
+                if (recording) replay.recordStep(sim, input, FIXED_DT);
+                sim.step(input, FIXED_DT);
+                tick++;
+                behind -= duration;
+            }
+        } else {
+            // Paused time is not made up for either
+            behind = FramePacer::Clock::duration::zero();
+            previousFleetOrigin = sim.fleetOrigin();
+            previousPlayerPosition = sim.player.getShape().getPosition();
+        }
+
+        publish(std::chrono::duration<float>(behind).count());
+        ticks.endFrame();
+
+        pacer.sleepUntil(lastWake + duration - behind);
+    }
+
+    threadProfiler = nullptr;
+}
+
+void SimThread::applyCommands() {
+    std::deque<SimCommand> pending;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pending.swap(commands);
+    }
+
+    for (auto& command : pending) {
+        switch (command.type) {
+        case SimCommandType::Restart:
+            sim.make(command.seed);
+            if (recording) replay.recordRestart(command.seed);
+            break;
+        case SimCommandType::NextRound:
+            sim.nextRound();
+            if (recording) replay.recordNextRound();
+            break;
+        case SimCommandType::ClearFleet:
+            sim.clearFleet();
+            if (recording) replay.recordClearFleet();
+            break;
+        case SimCommandType::Load:
+            // Checked against the caps the game runs with, a bad file
+            // leaves the game as it was
+            if (!sim.loadSnapshot(command.snapshot.data(), command.snapshot.size())) {
+                failedLoad = done + 1;
+                break;
+            }
+            if (recording) replay.recordLoad(sim);
+
+            // Saved from the post round menu, carry on with the next round
+            if (sim.ships.empty()) {
+                sim.nextRound();
+                if (recording) replay.recordNextRound();
+            }
+            break;
+        case SimCommandType::Save:
+            // Only the snapshot is taken here, the disk write happens in the background
+            saves.requestSave(command.path, sim.saveSnapshot());
+            break;
+        }
+        done++;
+    }
+}
+
+void SimThread::publish(float lag) {
+    RenderSnapshot& snapshot = snapshots.back();
+    takeSnapshot(sim, snapshot);
+
+    snapshot.tick = tick;
+    snapshot.commandsDone = done;
+    snapshot.failedLoad = failedLoad;
+    snapshot.lag = lag;
+    snapshot.previousFleetOrigin = previousFleetOrigin;
+    snapshot.previousPlayerPosition = previousPlayerPosition;
+
+    snapshots.publish();
+}
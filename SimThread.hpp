@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FramePacer.hpp"
+#include "Profiler.hpp"
+#include "RenderSnapshot.hpp"
+#include "Replay.hpp"
+#include "SaveService.hpp"
+#include "Simulation.hpp"
+#include "TripleBuffer.hpp"
+
+enum class SimCommandType {
+    Restart,
+    NextRound,
+    ClearFleet,
+    Load,
+    Save,
+};
+
+// Something the UI wants done to the game, applied by the simulation
+// thread between two ticks
+struct SimCommand {
+    SimCommand(SimCommandType type) : type(type) {}
+
+    SimCommandType type;
+    uint64_t seed = 0;              // Restart
+    std::vector<char> snapshot;     // Load
+    std::string path;               // Save
+};
+
+// Ticks the simulation thread may run back to back to catch up after a stall
+const int MAX_CATCH_UP_TICKS = 5;
+
+// Runs the simulation on its own thread at a fixed FIXED_DT rate, so the
+// game speed does not depend on how long drawing takes. Time the thread
+// fell behind is made up with extra ticks, up to MAX_CATCH_UP_TICKS. After
+// every wake up it publishes a RenderSnapshot through a triple buffer. The
+// window thread only ever sees those snapshots and changes the game by
+// sending commands.
+class SimThread {
+public:
+    SimThread(const SimConfig& config, SaveService& saves, std::function<InputFrame()> readInput);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // Both have to be called before start()
+    void startRecording();
+    void profileTo(const std::string& csvPath);
+
+    void start();
+    void stop();
+
+    // Only safe to look at once the thread is stopped
+    bool isRecording() const { return recording; }
+    const ReplayRecorder& recorder() const { return replay; }
+
+    // Window thread side. Returns the command's number, the first one is 1,
+    // see RenderSnapshot::commandsDone.
+    uint64_t send(SimCommand command);
+
+    // Ticks only advance while running (in a game and not paused), and the
+    // keyboard is only read while the window has focus
+    void setRunning(bool value) { running = value; }
+    void setFocused(bool value) { focused = value; }
+    void setProfiling(bool value) { profiling = value; }
+
+    // Newest published snapshot, call once per frame
+    const RenderSnapshot& snapshot();
+
+    // The simulation thread's profiler, null until the thread started
+    const Profiler* tickProfiler() const { return threadProfiler.load(); }
+
+private:
+    void run();
+    void applyCommands();
+    void publish(float lag);
+
+    Simulation sim;
+    SaveService& saves;
+    std::function<InputFrame()> readInput;
+
+    std::thread worker;
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> running{ false };
+    std::atomic<bool> focused{ true };
+    std::atomic<bool> profiling{ false };
+    std::string profilePath;
+    std::atomic<const Profiler*> threadProfiler{ nullptr };
+
+    std::mutex commandMutex;
+    std::deque<SimCommand> commands;
+    uint64_t sent = 0;
+    uint64_t done = 0;
+    uint64_t failedLoad = 0;
+
+    TripleBuffer<RenderSnapshot> snapshots;
+    uint64_t tick = 0;
+    sf::Vector2f previousFleetOrigin;
+    sf::Vector2f previousPlayerPosition;
+
+    ReplayRecorder replay;
+    bool recording = false;
+};
@@ -0,0 +1,867 @@
+#include "Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Profiler.hpp"
+#include "SaveFile.hpp"
+
+// Bullets per job in the parallel bullet passes
+const int BULLET_GRAIN = 256;
+
+// Most fleet slots a snapshot may ask for, far above any round that is
+// played, so a damaged size can not make loading allocate without limit
+const size_t MAX_FLEET_SLOTS = size_t(1) << 22;
+
+// Most lives a saved house or ship may have. Ships gain one a round, so no
+// game gets near it, and the health tint can multiply it without overflow.
+const int MAX_LIVES = 1 << 20;
+
+namespace {
+
+// Ticks in the given simulation time, at least one
+int ticksFor(float seconds) {
+    return std::max(1, static_cast<int>(std::lround(seconds / FIXED_DT)));
+}
+
+// Lives of a standing house or ship. One at 0 lives still stands, the
+// next hit destroys it.
+bool isValidLives(int32_t lives, int32_t maxLives) {
+    return maxLives > 0 && maxLives <= MAX_LIVES && lives >= 0 && lives <= maxLives;
+}
+
+}
+
+Simulation::Simulation() {
+    setConfig(config);
+}
+
+void Simulation::setConfig(const SimConfig& newConfig) {
+    config = newConfig;
+    if (!jobs || jobs->threadCount() != std::max(config.threads, 1)) {
+        jobs.reset(new JobSystem(config.threads));
+    }
+    bullets.setCapacity(config.maxPlayerBullets, config.maxShipBullets);
+    waves.clear();
+}
+
+void Simulation::make(uint64_t seed) {
+    // Player player;
+    isGameOver = false;
+
+    rng.seed(seed);
+
+    player.setShape();
+    player.getShape().setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1)));
+    player.getTotalLives() = 3;
+
+    player.respawn(isGameOver);
+
+    player.updateColor();
+
+    round = 1;
+    score = 0;
+
+    houses.clear();
+    bullets.clear();
+
+    spawnFleet();
+
+    timers.cancelAll();
+    canShoot = true;
+    isGraceOver = false;
+    timers.schedule(TIMER_GRACE_END, ticksFor(1.0f));
+    scheduleFleet();
+
+    int houseAmount = 4;
+    for (int i = 0; i < houseAmount; i++) {
+        houses.create(sf::Vector2f());
+    }
+
+    centerHouseOnGrid(houses, HOUSE_MARGIN_X);
+}
+
+void Simulation::nextRound() {
+    round++;
+    startNewRound();
+}
+
+void Simulation::startNewRound() {
+    bullets.clear();
+
+    player.getLives() = std::min(player.getLives() + 1, player.getMaxLives());
+    player.updateColor();
+    player.setIsAlive(true);
+    player.respawn(isGameOver);
+    timers.cancel(TIMER_RESPAWN);
+
+    spawnFleet();
+
+    isGraceOver = false;
+    timers.schedule(TIMER_GRACE_END, ticksFor(1.0f));
+    scheduleFleet();
+
+    // Repair houses slightly between rounds or make new ones
+    if (houses.size() > 0) {
+        for (int houseId = 0; houseId < houses.size(); houseId++) {
+            houses.setLives(houseId, std::min(houses.lives[houseId] + 2, houses.maxLives[houseId]), houses.maxLives[houseId]);
+        }
+    } else {
+        int houseAmount = std::min(round, 4);
+        for (int i = 0; i < houseAmount; i++) {
+            houses.create(sf::Vector2f());
+        }
+
+        centerHouseOnGrid(houses, HOUSE_MARGIN_X);
+    }
+}
+
+void Simulation::step(const InputFrame& input, float dt) {
+    // Scratch of the last tick is dropped
+    scratch.reset();
+
+    ProfileScope scope(PHASE_PLAYER);
+
+    if (player.update(input, dt, canShoot, bullets)) {
+        canShoot = false;
+        timers.schedule(TIMER_RELOAD, ticksFor(PLAYER_RELOAD_TIME));
+    }
+
+    // Move Player Bullets
+    moveBullets(BulletOwner::Player, dt);
+
+    scope.next(PHASE_SHIP_HITS);
+
+    // Bullet deals damage to ships
+    // Bullets are moved into formation space instead of moving every ship
+    // out of it. A ship that dies leaves its slot and the store at once.
+    // A bullet hits the ship its path of this tick enters first, so a long
+    // tick can not carry it past a row unharmed.
+    sf::Vector2f fleetOrigin = formation.getOrigin();
+    int fleetColumns = formation.columns();
+    auto slotAlive = [&](int slot) {
+        return !formation.slotShip(slot % fleetColumns, slot / fleetColumns).isNull();
+    };
+
+    // Houses only change in their own passes, the ship pass looks at them
+    // too so a bullet that reaches a house before any ship is left to it
+    buildHouseGrid();
+    auto anyHouse = [](int) { return true; };
+    auto shipHit = [&](int bulletId) {
+        SweptHit ship = shipGrid.findEarliest(bullets.path(bulletId, dt, fleetOrigin), slotAlive);
+        if (ship.id != -1 && houseGrid.findEarliest(bullets.path(bulletId, dt), anyHouse).entry < ship.entry) {
+            return -1;
+        }
+        return ship.id;
+    };
+
+    // The tests only read the fleet, so they run in parallel against the
+    // fleet as it was before any of these bullets hit
+    FrameVector<int> firstHit(bullets.size(), -1, FrameAllocator<int>(scratch));
+    jobs->parallelFor(bullets.size(), BULLET_GRAIN, [&](int begin, int end) {
+        for (int bulletId = begin; bulletId < end; bulletId++) {
+            bool isTested = bullets.owner[bulletId] == BulletOwner::Player && !ships.empty();
+            firstHit[bulletId] = isTested ? shipHit(bulletId) : -1;
+        }
+    });
+
+    // The hits are then applied in bullet order. Ships only ever leave, so
+    // a first hit that is still alive is the same answer a fresh test would
+    // give, and only bullets whose ship died earlier in the pass look again.
+    int shipsBefore = ships.size();
+    for (int bulletId = 0; bulletId < bullets.size();) {
+        if (bullets.owner[bulletId] != BulletOwner::Player || ships.empty()) {
+            bulletId++;
+            continue;
+        }
+
+        int slot = firstHit[bulletId];
+        if (slot != -1 && !slotAlive(slot)) {
+            slot = shipHit(bulletId);
+        }
+
+        if (slot != -1) {
+            int column = slot % fleetColumns;
+            int row = slot / fleetColumns;
+            int blockId = ships.find(formation.slotShip(column, row));
+
+            if (ships.lives[blockId] <= 0) {
+                formation.remove(column, row);
+                ships.remove(blockId);
+                score += 50;
+            } else {
+                ships.damage(blockId, 1);
+                score += 10;
+            }
+            bullets.remove(bulletId);
+            firstHit[bulletId] = firstHit[bullets.size()];
+        } else {
+            bulletId++;
+        }
+    }
+
+    // A smaller fleet is faster, also for the delays that are running
+    if (ships.size() != shipsBefore) scheduleFleet();
+
+    scope.next(PHASE_PLAYER_HOUSE_HITS);
+
+    // Player bullets deals damage to the houses
+    bulletsHitHouses(BulletOwner::Player, dt);
+    dropGoneBullets(BulletOwner::Player);
+
+    scope.next(PHASE_SHOOTERS);
+
+    // Add a bit of a grace time at the start of the round/game
+    // Only the lowest ship of every column can shoot
+    FrameVector<int> shooters{ FrameAllocator<int>(scratch) };
+    shooters.reserve(formation.columns());
+    if (isGraceOver) {
+        for (int column = 0; column < formation.columns(); column++) {
+            EntityHandle ship = formation.bottomShip(column);
+            if (!ship.isNull()) {
+                shooters.push_back(ships.find(ship));
+            }
+        }
+    }
+
+    scope.next(PHASE_FLEET);
+
+    // Fleet steps, volleys, the end of the grace time, respawns and reloads
+    timers.advance([&](int timer) { fireTimer(timer, shooters); });
+
+    // Check if the front line of the fleet got too low
+    for (const auto& shipId : shooters) {
+        if (shipPosition(shipId).y >= WINDOW_SIZE.y * 0.71) {
+            isGameOver = true;
+        }
+    }
+
+    scope.next(PHASE_SHIP_BULLETS);
+
+    // Move block bullets
+    moveBullets(BulletOwner::Ship, dt);
+
+    scope.next(PHASE_SHIP_HOUSE_HITS);
+
+    // Ship bullets destroy houses
+    bulletsHitHouses(BulletOwner::Ship, dt);
+
+    scope.next(PHASE_PLAYER_HITS);
+
+    // Ship bullets damages player
+    // Every path is tested against the player at once, AABB_LANES at a
+    // time, and the ones that pass over the player are then swept exactly.
+    // The player does not move during the pass, so the tests stay valid
+    // while the hits are applied in order.
+    AabbQuery playerBounds(player.getShape().getGlobalBounds());
+    int padded = bullets.size() + AABB_LANES;
+    FrameVector<float> pathMinX(padded, 0.f, FrameAllocator<float>(scratch));
+    FrameVector<float> pathMinY(padded, 0.f, FrameAllocator<float>(scratch));
+    FrameVector<float> pathMaxX(padded, 0.f, FrameAllocator<float>(scratch));
+    FrameVector<float> pathMaxY(padded, 0.f, FrameAllocator<float>(scratch));
+    for (int bulletId = 0; bulletId < bullets.size(); bulletId++) {
+        AabbQuery edges = bullets.path(bulletId, dt).bounds();
+        pathMinX[bulletId] = edges.minX;
+        pathMinY[bulletId] = edges.minY;
+        pathMaxX[bulletId] = edges.maxX;
+        pathMaxY[bulletId] = edges.maxY;
+    }
+    FrameVector<uint8_t> touchesPlayer(bullets.size(), 0, FrameAllocator<uint8_t>(scratch));
+    overlapAll(playerBounds, pathMinX.data(), pathMinY.data(), pathMaxX.data(), pathMaxY.data(),
+        bullets.size(), touchesPlayer.data());
+    for (int bulletId = 0; bulletId < bullets.size(); bulletId++) {
+        if (touchesPlayer[bulletId]) {
+            float entry = bullets.path(bulletId, dt).entry(playerBounds.minX, playerBounds.minY,
+                playerBounds.maxX, playerBounds.maxY);
+            touchesPlayer[bulletId] = entry != SWEEP_MISS;
+        }
+    }
+
+    for (int bulletId = 0; bulletId < bullets.size();) {
+        if (bullets.owner[bulletId] != BulletOwner::Ship) {
+            bulletId++;
+            continue;
+        }
+
+        bool bulletHit = false;
+
+        if (touchesPlayer[bulletId] && player.getIsAlive()) {
+            player.damage(1);
+            player.updateColor();
+
+            if (player.getLives() <= 0) {
+                player.damageTotalLives(1);
+                player.getIsAlive() = false;
+                timers.schedule(TIMER_RESPAWN, ticksFor(player.getRespawnDelay()));
+            }
+
+            bulletHit = true;
+        }
+
+        if (bulletHit) {
+            bullets.remove(bulletId);
+            touchesPlayer[bulletId] = touchesPlayer[bullets.size()];
+        } else {
+            bulletId++;
+        }
+    }
+
+    dropGoneBullets(BulletOwner::Ship);
+}
+
+float Simulation::harder() const {
+    float amount;
+    if (ships.size() > 2) {
+        amount = (5. / ships.size()) + (round * config.harderPerRound);
+    } else {
+        amount = 1.3 + (round * config.harderPerRound);
+    }
+
+    return std::min(amount, config.maxHarder);
+}
+
+void Simulation::scheduleFleet() {
+    // A delay that is already over fires on the next tick
+    for (int timer : { TIMER_FLEET_STEP, TIMER_VOLLEY }) {
+        if (!timers.isPending(timer)) {
+            startFleetTimer(timer);
+            continue;
+        }
+        uint64_t since = timer == TIMER_FLEET_STEP ? fleetStepSince : volleySince;
+        int64_t left = static_cast<int64_t>(since + fleetDelay(timer) - timers.tick());
+        timers.schedule(timer, static_cast<int>(std::max<int64_t>(left, 1)));
+    }
+}
+
+void Simulation::startFleetTimer(int timer) {
+    (timer == TIMER_FLEET_STEP ? fleetStepSince : volleySince) = timers.tick();
+    timers.schedule(timer, fleetDelay(timer));
+}
+
+int Simulation::fleetDelay(int timer) const {
+    return ticksFor((timer == TIMER_FLEET_STEP ? 2.0f : 3.0f) - harder());
+}
+
+void Simulation::fireTimer(int timer, const FrameVector<int>& shooters) {
+    switch (timer) {
+    case TIMER_FLEET_STEP:
+        // Move ships
+        if (harder() > 0.3) {
+            formation.move(sf::Vector2f(0.0, 3.0));
+        } else {
+            formation.move(sf::Vector2f(0.0, 1.0));
+        }
+        startFleetTimer(TIMER_FLEET_STEP);
+        break;
+    case TIMER_VOLLEY:
+        fireVolley(shooters);
+        break;
+    case TIMER_GRACE_END:
+        isGraceOver = true;
+        break;
+    case TIMER_RESPAWN:
+        player.respawn(isGameOver);
+        break;
+    case TIMER_RELOAD:
+        canShoot = true;
+        break;
+    }
+}
+
+void Simulation::fireVolley(const FrameVector<int>& shooters) {
+    // Nobody can shoot yet, tried again every tick until someone can
+    if (shooters.empty() || bullets.countOf(BulletOwner::Ship) >= config.maxShipBullets) {
+        timers.schedule(TIMER_VOLLEY, 1);
+        return;
+    }
+
+    // Random amount of bullets are shoot by random amount of the ships
+    int maxAmount = 4;
+
+    if (shooters.size() < 5) {
+        maxAmount = shooters.size();
+    }
+
+    int minAmount = 0;
+
+    size_t randAmount = rng.nextInt(maxAmount - minAmount + 1) + minAmount;
+    FrameVector<int> volley{ FrameAllocator<int>(scratch) };
+    volley.reserve(randAmount);
+
+    while (volley.size() < randAmount) {
+        int randInt = rng.nextInt(shooters.size());
+
+        if (std::count(volley.begin(), volley.end(), randInt) == 0) {
+            volley.push_back(randInt);
+        }
+    }
+
+    for (const auto& id : volley) {
+        sf::Vector2f blockCenter = shipPosition(shooters[id]) +
+            sf::Vector2f(50. / 2.f, 20.);
+
+        bullets.spawn(blockCenter, sf::Vector2f(0, BULLET_SPEED), BulletOwner::Ship);
+    }
+
+    startFleetTimer(TIMER_VOLLEY);
+}
+
+void Simulation::clearFleet() {
+    ships.clear();
+    formation.reset(0, 0);
+    scheduleFleet();
+}
+
+void Simulation::buildShipGrid(const FormationIndex& layout, SpatialGrid& grid) {
+    // One box per slot, numbered row by row like the ships were created.
+    // The boxes are relative to the formation origin, so the grid stays
+    // valid while the fleet moves and only has to be built once per wave.
+    std::vector<sf::FloatRect> slotBounds;
+    slotBounds.reserve(layout.columns() * layout.rows());
+    for (int row = 0; row < layout.rows(); row++) {
+        for (int column = 0; column < layout.columns(); column++) {
+            sf::Vector2f offset = layout.slotOffset(column, row);
+            slotBounds.push_back(ShipKind::bounds(offset));
+        }
+    }
+    grid.build(slotBounds);
+}
+
+void Simulation::spawnFleet() {
+    auto found = std::find_if(waves.begin(), waves.end(),
+        [&](const WaveBlueprint& wave) { return wave.round == round; });
+    if (found == waves.end()) {
+        if (waves.size() >= WAVE_CACHE_SIZE) waves.pop_back();
+        waves.insert(waves.begin(), buildWave(round));
+    } else {
+        std::rotate(waves.begin(), found, found + 1);
+    }
+    const WaveBlueprint& wave = waves.front();
+
+    // Copies into the storage the last fleet left behind
+    ships.assign(wave.ships);
+    formation.reset(wave.layout.columns(), wave.layout.rows());
+    formation.setLayout(wave.layout.getOrigin(), wave.layout.getPitch());
+    for (int shipId = 0; shipId < ships.size(); shipId++) {
+        formation.place(ships.column[shipId], ships.row[shipId], ships.handle(shipId));
+    }
+    shipGrid = wave.grid;
+}
+
+WaveBlueprint Simulation::buildWave(int round) {
+    WaveBlueprint wave;
+    wave.round = round;
+
+    // Ships get more health every round
+    int shipsAmount = FIRST_ROUND_SHIPS + (round - 1) * config.extraShipsPerRound;
+    for (int i = 0; i < shipsAmount; i++) {
+        wave.ships.create(sf::Vector2f());
+    }
+
+    int gridCol = FLEET_COLUMNS;
+    int gridRow = (shipsAmount + gridCol - 1) / gridCol; // Calculate rows needed
+
+    centerBlockOnGrid(
+        wave.ships, wave.layout,
+        gridCol, gridRow,
+        SHIP_MARGIN_X, SHIP_MARGIN_Y
+    );
+    buildShipGrid(wave.layout, wave.grid);
+
+    for (int shipId = 0; shipId < wave.ships.size(); shipId++) {
+        int health = wave.ships.maxLives[shipId] + (round - 1);
+        wave.ships.setLives(shipId, health, health);
+    }
+
+    return wave;
+}
+
+void Simulation::moveBullets(BulletOwner who, float dt) {
+    // Every bullet moves on its own, only dropping them has to be in order
+    jobs->parallelFor(bullets.size(), BULLET_GRAIN, [&](int begin, int end) {
+        for (int bulletId = begin; bulletId < end; bulletId++) {
+            if (bullets.owner[bulletId] == who) {
+                bullets.x[bulletId] += bullets.vx[bulletId] * dt;
+                bullets.y[bulletId] += bullets.vy[bulletId] * dt;
+            }
+        }
+    });
+}
+
+void Simulation::dropGoneBullets(BulletOwner who) {
+    for (int bulletId = 0; bulletId < bullets.size();) {
+        bool isGone = who == BulletOwner::Player
+            ? bullets.y[bulletId] + BULLET_SIZE.y < 0
+            : bullets.y[bulletId] > WINDOW_SIZE.y;
+
+        if (bullets.owner[bulletId] == who && isGone) {
+            bullets.remove(bulletId);
+        } else {
+            bulletId++;
+        }
+    }
+}
+
+void Simulation::bulletsHitHouses(BulletOwner who, float dt) {
+    FrameVector<char> targetDead(houses.size(), false, FrameAllocator<char>(scratch));
+
+    auto houseStanding = [&](int id) { return !targetDead[id]; };
+
+    // Same as the ship pass: tested in parallel, applied in order, and
+    // looked at again only if the house fell earlier in the pass
+    FrameVector<int> firstHit(bullets.size(), -1, FrameAllocator<int>(scratch));
+    jobs->parallelFor(bullets.size(), BULLET_GRAIN, [&](int begin, int end) {
+        for (int bulletId = begin; bulletId < end; bulletId++) {
+            firstHit[bulletId] = bullets.owner[bulletId] == who
+                ? houseGrid.findEarliest(bullets.path(bulletId, dt), houseStanding).id
+                : -1;
+        }
+    });
+
+    for (int bulletId = 0; bulletId < bullets.size();) {
+        if (bullets.owner[bulletId] != who) {
+            bulletId++;
+            continue;
+        }
+
+        int houseId = firstHit[bulletId];
+        if (houseId != -1 && targetDead[houseId]) {
+            houseId = houseGrid.findEarliest(bullets.path(bulletId, dt), houseStanding).id;
+        }
+
+        if (houseId != -1) {
+            if (houses.lives[houseId] == 0) {
+                targetDead[houseId] = true;
+            } else {
+                houses.damage(houseId, 1);
+            }
+            bullets.remove(bulletId);
+            firstHit[bulletId] = firstHit[bullets.size()];
+        } else {
+            bulletId++;
+        }
+    }
+
+    // From the back, so the house swapped into a gap was already looked at
+    bool anyFell = false;
+    for (int houseId = houses.size() - 1; houseId >= 0; houseId--) {
+        if (targetDead[houseId]) {
+            houses.remove(houseId);
+            anyFell = true;
+        }
+    }
+
+    // Ids moved, the next pass needs a grid of the houses left
+    if (anyFell) buildHouseGrid();
+}
+
+void Simulation::buildHouseGrid() {
+    FrameVector<sf::FloatRect> houseBounds{ FrameAllocator<sf::FloatRect>(scratch) };
+    houseBounds.reserve(houses.size());
+    for (const auto& position : houses.position) {
+        houseBounds.push_back(HouseKind::bounds(position));
+    }
+    houseGrid.build(houseBounds.data(), houseBounds.size());
+}
+
+std::vector<char> Simulation::saveSnapshot() const {
+    SnapshotWriter writer;
+
+    writer.beginSection(SECTION_META);
+    writer.put<int32_t>(round);
+    writer.put<int32_t>(score);
+    writer.put<uint8_t>(isGameOver);
+    writer.put<uint64_t>(rng.getState());
+
+    writer.beginSection(SECTION_PLAYER);
+    writer.put<int32_t>(player.getLives());
+    writer.put<int32_t>(player.getTotalLives());
+    writer.put<uint8_t>(player.getIsAlive());
+    writer.put<float>(player.getShape().getPosition().x);
+    writer.put<float>(player.getShape().getPosition().y);
+
+    writer.beginSection(SECTION_HOUSES);
+    writer.put<uint32_t>(houses.size());
+    for (int houseId = 0; houseId < houses.size(); houseId++) {
+        writer.put<int32_t>(houses.lives[houseId]);
+        writer.put<int32_t>(houses.maxLives[houseId]);
+        writer.put<float>(houses.position[houseId].x);
+        writer.put<float>(houses.position[houseId].y);
+    }
+
+    writer.beginSection(SECTION_FLEET);
+    writer.put<int32_t>(formation.columns());
+    writer.put<int32_t>(formation.rows());
+    writer.put<float>(formation.getOrigin().x);
+    writer.put<float>(formation.getOrigin().y);
+    writer.put<float>(formation.getPitch().x);
+    writer.put<float>(formation.getPitch().y);
+    writer.put<uint32_t>(ships.size());
+    for (int shipId = 0; shipId < ships.size(); shipId++) {
+        writer.put<int32_t>(ships.column[shipId]);
+        writer.put<int32_t>(ships.row[shipId]);
+        writer.put<int32_t>(ships.lives[shipId]);
+        writer.put<int32_t>(ships.maxLives[shipId]);
+    }
+
+    writer.beginSection(SECTION_TIMERS);
+    writer.put<uint8_t>(isGraceOver);
+    writer.put<uint8_t>(canShoot);
+    for (int timer = 0; timer < TIMER_COUNT; timer++) {
+        writer.put<int32_t>(timers.remaining(timer));
+    }
+    writer.put<int32_t>(static_cast<int32_t>(timers.tick() - fleetStepSince));
+    writer.put<int32_t>(static_cast<int32_t>(timers.tick() - volleySince));
+
+    writer.beginSection(SECTION_BULLETS);
+    writer.put<uint32_t>(bullets.size());
+    for (int bulletId = 0; bulletId < bullets.size(); bulletId++) {
+        writer.put<float>(bullets.x[bulletId]);
+        writer.put<float>(bullets.y[bulletId]);
+        writer.put<float>(bullets.vx[bulletId]);
+        writer.put<float>(bullets.vy[bulletId]);
+        writer.put<uint8_t>(static_cast<uint8_t>(bullets.owner[bulletId]));
+    }
+
+    return writer.finish();
+}
+
+bool Simulation::loadSnapshot(const char* data, size_t size) {
+    SnapshotReader reader;
+    if (!reader.open(data, size)) return false;
+
+    SectionView meta, playerView, houseView, fleetView, timerView, bulletView;
+    if (!reader.section(SECTION_META, meta) ||
+        !reader.section(SECTION_PLAYER, playerView) ||
+        !reader.section(SECTION_HOUSES, houseView) ||
+        !reader.section(SECTION_FLEET, fleetView) ||
+        !reader.section(SECTION_TIMERS, timerView) ||
+        !reader.section(SECTION_BULLETS, bulletView)) {
+        return false;
+    }
+
+    // Everything is read into temporaries first, so a bad snapshot leaves
+    // the running game exactly as it was
+    int32_t newRound, newScore;
+    uint8_t newIsGameOver;
+    uint64_t newRngState;
+    if (!meta.get(newRound) || !meta.get(newScore) || !meta.get(newIsGameOver) || !meta.get(newRngState)) {
+        return false;
+    }
+
+    int32_t playerLives, playerTotalLives;
+    uint8_t playerAlive;
+    sf::Vector2f playerPos;
+    if (!playerView.get(playerLives) || !playerView.get(playerTotalLives) || !playerView.get(playerAlive) ||
+        !playerView.get(playerPos.x) || !playerView.get(playerPos.y)) {
+        return false;
+    }
+    // A dead player is saved with 0 lives
+    if (playerLives < 0 || playerLives > player.getMaxLives() || playerTotalLives < 0) return false;
+
+    // Ticks until each timer fires, -1 for idle ones, then the ticks the
+    // fleet step and volley delays have been running
+    uint8_t newIsGraceOver, newCanShoot;
+    int32_t newTimers[TIMER_COUNT];
+    int32_t fleetStepElapsed = 0, volleyElapsed = 0;
+    if (!timerView.get(newIsGraceOver) || !timerView.get(newCanShoot) ||
+        timerView.remaining() != sizeof(newTimers) + 2 * sizeof(int32_t)) {
+        return false;
+    }
+    for (int timer = 0; timer < TIMER_COUNT; timer++) {
+        timerView.get(newTimers[timer]);
+        if (newTimers[timer] < -1 || newTimers[timer] == 0) return false;
+    }
+    timerView.get(fleetStepElapsed);
+    timerView.get(volleyElapsed);
+    if (fleetStepElapsed < 0 || volleyElapsed < 0) return false;
+
+    uint32_t houseCount;
+    if (!houseView.get(houseCount) || houseView.remaining() != houseCount * 16ull) return false;
+
+    HouseStore newHouses;
+    for (uint32_t i = 0; i < houseCount; i++) {
+        int32_t lives = 0, maxLives = 0;
+        sf::Vector2f pos;
+        houseView.get(lives);
+        houseView.get(maxLives);
+        houseView.get(pos.x);
+        houseView.get(pos.y);
+
+        if (!isValidLives(lives, maxLives)) return false;
+        newHouses.create(pos, maxLives);
+        newHouses.setLives(i, lives, maxLives);
+    }
+
+    int32_t columns, rows;
+    sf::Vector2f origin, pitch;
+    uint32_t shipCount;
+    if (!fleetView.get(columns) || !fleetView.get(rows) ||
+        !fleetView.get(origin.x) || !fleetView.get(origin.y) || !fleetView.get(pitch.x) || !fleetView.get(pitch.y) ||
+        !fleetView.get(shipCount) || fleetView.remaining() != shipCount * 16ull) {
+        return false;
+    }
+    // A cleared fleet is saved as 0 x 0, any other fleet needs both sides
+    bool isEmptyFleet = columns == 0 && rows == 0;
+    if (!isEmptyFleet && (columns <= 0 || rows <= 0)) return false;
+    size_t slots = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+    if (slots > MAX_FLEET_SLOTS || slots < shipCount) return false;
+
+    ShipStore newShips;
+    std::vector<char> taken(slots, false);
+    for (uint32_t i = 0; i < shipCount; i++) {
+        int32_t column = 0, row = 0, lives = 0, maxLives = 0;
+        fleetView.get(column);
+        fleetView.get(row);
+        fleetView.get(lives);
+        fleetView.get(maxLives);
+
+        if (column < 0 || column >= columns || row < 0 || row >= rows) return false;
+        size_t slot = static_cast<size_t>(column) * rows + row;
+        if (taken[slot] || !isValidLives(lives, maxLives)) return false;
+        taken[slot] = true;
+
+        newShips.create(sf::Vector2f(column * pitch.x, row * pitch.y), maxLives);
+        newShips.column[i] = column;
+        newShips.row[i] = row;
+        newShips.setLives(i, lives, maxLives);
+    }
+
+    uint32_t bulletCount;
+    if (!bulletView.get(bulletCount) || bulletView.remaining() != bulletCount * 17ull) return false;
+
+    // Bullets are checked here and spawned once nothing can fail anymore.
+    // A snapshot with more bullets than the caps allow does not load, the
+    // pool would have to drop some of them.
+    SectionView bulletRecords = bulletView;
+    int ownerCount[2] = { 0, 0 };
+    for (uint32_t i = 0; i < bulletCount; i++) {
+        float values[4];
+        uint8_t owner = 0;
+        bulletView.get(values[0]);
+        bulletView.get(values[1]);
+        bulletView.get(values[2]);
+        bulletView.get(values[3]);
+        bulletView.get(owner);
+        if (owner > static_cast<uint8_t>(BulletOwner::Ship)) return false;
+        ownerCount[owner]++;
+    }
+    if (ownerCount[static_cast<int>(BulletOwner::Player)] > config.maxPlayerBullets ||
+        ownerCount[static_cast<int>(BulletOwner::Ship)] > config.maxShipBullets) {
+        return false;
+    }
+
+    round = newRound;
+    score = newScore;
+    isGameOver = newIsGameOver != 0;
+    rng.setState(newRngState);
+
+    isGraceOver = newIsGraceOver != 0;
+    canShoot = newCanShoot != 0;
+    timers.cancelAll();
+    for (int timer = 0; timer < TIMER_COUNT; timer++) {
+        if (newTimers[timer] != -1) timers.schedule(timer, newTimers[timer]);
+    }
+    // May wrap below tick 0 on a fresh wheel, scheduleFleet() only ever
+    // looks at the difference
+    fleetStepSince = timers.tick() - fleetStepElapsed;
+    volleySince = timers.tick() - volleyElapsed;
+
+    player.getLives() = playerLives;
+    player.getTotalLives() = playerTotalLives;
+    player.setIsAlive(playerAlive != 0);
+    player.getShape().setPosition(playerPos);
+    player.updateColor();
+
+    houses.assign(newHouses);
+
+    ships.assign(newShips);
+    formation.reset(columns, rows);
+    formation.setLayout(origin, pitch);
+    for (int shipId = 0; shipId < ships.size(); shipId++) {
+        formation.place(ships.column[shipId], ships.row[shipId], ships.handle(shipId));
+    }
+    buildShipGrid(formation, shipGrid);
+
+    bullets.clear();
+    for (uint32_t i = 0; i < bulletCount; i++) {
+        sf::Vector2f pos, velocity;
+        uint8_t owner = 0;
+        bulletRecords.get(pos.x);
+        bulletRecords.get(pos.y);
+        bulletRecords.get(velocity.x);
+        bulletRecords.get(velocity.y);
+        bulletRecords.get(owner);
+        bullets.spawn(pos, velocity, static_cast<BulletOwner>(owner));
+    }
+
+    return true;
+}
+
+bool Simulation::saveGame(const std::string& path) const {
+    return writeFileAtomic(path, saveSnapshot());
+}
+
+bool Simulation::loadGame(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    return loadSnapshot(file.data(), file.size());
+}
+
+void centerBlockOnGrid(
+    ShipStore& ships, FormationIndex& formation,
+    int gridColumns, int gridRows,
+    float marginX, float marginY
+) {
+    formation.reset(std::max(gridColumns, 0), std::max(gridRows, 0));
+    if (ships.empty() || gridColumns <= 0 || gridRows <= 0) return;
+
+    sf::Vector2f rectSize = SHIP_SIZE;
+
+    float gridWidth = gridColumns * rectSize.x + (gridColumns - 1) * marginX;
+    float gridHeight = gridRows * rectSize.y + (gridRows - 1) * marginY;
+
+    float startX = ((WINDOW_SIZE.x - gridWidth) / 2.0f);
+    float startY = ((WINDOW_SIZE.y - gridHeight) / 2.0f) - (WINDOW_SIZE.y - gridHeight) * 0.30;
+
+    // Ships are placed relative to the top left slot
+    formation.setLayout(
+        sf::Vector2f(startX, startY),
+        sf::Vector2f(rectSize.x + marginX, rectSize.y + marginY)
+    );
+
+    int count = 0;
+    for (int row = 0; row < gridRows; ++row) {
+        int livesForRow = gridRows - row;
+
+        for (int col = 0; col < gridColumns; ++col) {
+            if (count >= ships.size()) break;
+
+            ships.position[count] = formation.slotOffset(col, row);
+            ships.column[count] = col;
+            ships.row[count] = row;
+            ships.setLives(count, livesForRow, livesForRow);
+            formation.place(col, row, ships.handle(count));
+            ++count;
+        }
+    }
+}
+
+void centerHouseOnGrid(HouseStore& houses, float marginX) {
+    if (houses.empty()) return;
+
+    // 50 x 30
+    sf::Vector2f rectSize = HOUSE_SIZE;
+
+    int numHouses = houses.size();
+    float largeMargin = marginX * 3;
+    float totalWidth = (numHouses * rectSize.x) + ((numHouses - 1) * largeMargin);
+    float startX = (WINDOW_SIZE.x - totalWidth) / 2.0f;
+    float y = WINDOW_SIZE.y * 0.82f;
+
+    for (int i = 0; i < numHouses; ++i) {
+        float x = startX + i * (rectSize.x + largeMargin);
+        houses.position[i] = sf::Vector2f(x, y);
+    }
+}
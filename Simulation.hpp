@@ -0,0 +1,350 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BulletPool.hpp"
+#include "EntityStore.hpp"
+#include "FrameArena.hpp"
+#include "FormationIndex.hpp"
+#include "JobSystem.hpp"
+#include "Random.hpp"
+#include "SpatialGrid.hpp"
+#include "TimerWheel.hpp"
+
+const sf::Vector2f WINDOW_SIZE = sf::Vector2f(800, 600);
+
+// Length of one simulation tick used by the headless runner
+const float FIXED_DT = 1.f / 60.f;
+
+// Seconds between two shots of the player
+const float PLAYER_RELOAD_TIME = 0.45f;
+
+// Layout of the enemy fleet, see centerBlockOnGrid()
+const sf::Vector2f SHIP_SIZE = sf::Vector2f(50, 20);
+const float SHIP_MARGIN_X = 10;
+const float SHIP_MARGIN_Y = 15;
+const int FLEET_COLUMNS = 10;
+// Ships of round 1, later rounds add SimConfig::extraShipsPerRound each
+const int FIRST_ROUND_SHIPS = 50;
+// Broadphase cell, one per ship slot
+const sf::Vector2f SHIP_CELL_SIZE = sf::Vector2f(SHIP_SIZE.x + SHIP_MARGIN_X, SHIP_SIZE.y + SHIP_MARGIN_Y);
+
+// Layout of the houses, see centerHouseOnGrid()
+const sf::Vector2f HOUSE_SIZE = sf::Vector2f(50, 30);
+const float HOUSE_MARGIN_X = 35;
+
+// Everything the player can do during a single tick.
+// Filled from the keyboard in the windowed game or by a script when headless.
+struct InputFrame {
+    int moveDir = 0; // -1 left, 0 none, 1 right
+    bool shoot = false;
+};
+
+// Outline and tint come from Kind, see EntityKinds.hpp
+template <typename Kind>
+class Destroyable {
+protected:
+    sf::ConvexShape shape;
+    int lives;
+    int maxLives;
+public:
+    Destroyable() : lives(0), maxLives(0) {}
+
+    void updateColor() {
+        shape.setFillColor(Kind::tint(lives, maxLives));
+    }
+
+    void setShape() {
+        shape = Kind::makeShape();
+    }
+
+    void setLives(const int& num) {
+        lives = num;
+    }
+
+    void damage(const int& num) {
+        lives -= num;
+    }
+
+    sf::ConvexShape& getShape() {
+        return shape;
+    }
+
+    const sf::ConvexShape& getShape() const {
+        return shape;
+    }
+
+    int& getLives() {
+        return lives;
+    }
+
+    int getLives() const {
+        return lives;
+    }
+
+    int& getMaxLives() {
+        return maxLives;
+    }
+
+    int getMaxLives() const {
+        return maxLives;
+    }
+};
+
+// Ships and houses are plain entries of an EntityStore
+class Player : public Destroyable<PlayerKind> {
+private:
+    float speed;
+    int totalLives;
+
+    bool isAlive;
+    float respawnDelay;
+public:
+    Player() {
+        // Match the original struct's life values
+        lives = PlayerKind::START_LIVES;        // This was currentLives in the struct
+        maxLives = PlayerKind::START_LIVES;
+        totalLives = 3;
+
+        isAlive = true;
+        respawnDelay = 5.0f;
+
+        speed = 250.f;
+
+        this->setShape();
+        shape.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2.0f, WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1f)));
+    }
+
+    void setShape() {
+        Destroyable::setShape();
+        shape.setOrigin(sf::Vector2f(PlayerKind::ORIGIN.x, PlayerKind::ORIGIN.y));
+    }
+
+    void updateColor() {
+        if (!isAlive) {
+            shape.setFillColor(sf::Color::Transparent);
+            return;
+        }
+
+        Destroyable::updateColor();
+    }
+
+    void respawn(bool& isGameOver) {
+        if (totalLives > 0) {
+            isAlive = true;
+            lives = maxLives;
+            updateColor();
+            this->getShape().setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1)));
+        } else {
+            isGameOver = true;
+        }
+    }
+
+    // Returns true if the player fired. Respawning and reloading are
+    // timers of the Simulation.
+    bool update(const InputFrame& input, float deltaTime, bool mayShoot, BulletPool& bullets) {
+        if (!isAlive) return false;
+
+        shape.move(sf::Vector2f(input.moveDir * speed * deltaTime, 0));
+
+        // Player Shooting
+        bool shot = false;
+        if (mayShoot && input.shoot) {
+            bullets.spawn(shape.getPosition(), sf::Vector2f(0, -BULLET_SPEED), BulletOwner::Player);
+            shot = true;
+        }
+
+        // Bound player pos to screen borders
+        sf::Vector2f playerPos = shape.getPosition();
+        sf::Vector2f playerSize = sf::Vector2f(shape.getPoint(5).x, shape.getPoint(2).y);
+        if (playerPos.x - playerSize.x / 2. < 0) {
+            shape.setPosition(sf::Vector2f(playerSize.x / 2., playerPos.y));
+        }
+        if (playerPos.x + playerSize.x / 2. > WINDOW_SIZE.x) {
+            shape.setPosition(sf::Vector2f(WINDOW_SIZE.x - playerSize.x / 2., playerPos.y));
+        }
+        return shot;
+    }
+
+    void setIsAlive(bool b) { isAlive = b; }
+    bool& getIsAlive() { return isAlive; }
+    bool getIsAlive() const { return isAlive; }
+    int& getTotalLives() { return totalLives; }
+    int getTotalLives() const { return totalLives; }
+    float getRespawnDelay() const { return respawnDelay; }
+    void damageTotalLives(int num) { totalLives -= num; }
+};
+
+// Helper functions
+void centerBlockOnGrid(
+    ShipStore& ships, FormationIndex& formation,
+    int gridColumns, int gridRows,
+    float marginX, float marginY
+);
+
+void centerHouseOnGrid(HouseStore& houses, float marginX);
+
+// The fleet a round starts with: every ship's slot, lives and tint, the
+// formation layout and the broadphase grid over it. Only the round decides
+// what it looks like, so a round that starts again (round 1 of every new
+// game, a reloaded round) is a bulk copy of the blueprint.
+struct WaveBlueprint {
+    int round = 0;
+    ShipStore ships;
+    // Only the layout is used, the slots refer to the blueprint's ships
+    FormationIndex layout;
+    SpatialGrid grid{ SHIP_CELL_SIZE };
+};
+
+// Starting size of the per tick scratch, grows if a tick needs more
+const size_t SCRATCH_BYTES = 64 * 1024;
+
+// Wave blueprints kept around, the least recently used one goes first
+const size_t WAVE_CACHE_SIZE = 4;
+
+// Everything in the game that happens after a delay, see Simulation::timers.
+// Timers due on the same tick fire in this order, so the fleet steps
+// before it shoots.
+enum SimTimer {
+    TIMER_FLEET_STEP,   // The fleet moves down
+    TIMER_VOLLEY,       // Some of the lowest ships shoot
+    TIMER_GRACE_END,    // Ships may shoot in a new round
+    TIMER_RESPAWN,      // A dead player comes back
+    TIMER_RELOAD,       // The player may shoot again
+    TIMER_COUNT,
+};
+
+// Tunables that are not part of the saved game
+struct SimConfig {
+    // How many bullets may be in flight at once, 1 to MAX_BULLETS each
+    int maxPlayerBullets = 50;
+    int maxShipBullets = 50;
+
+    // Threads the bullet passes are split across. The outcome is the same
+    // for any number, it only pays off with thousands of bullets.
+    int threads = 1;
+
+    // Difficulty, see Simulation::harder(). Only the batch runner changes
+    // these, replays assume the defaults.
+    int extraShipsPerRound = 3;
+    float harderPerRound = 0.1f;
+    float maxHarder = 1.5f;
+};
+
+// All of the game rules, without any window, font or wall clock.
+// The windowed game and the headless runner both drive it through step().
+class Simulation {
+public:
+    Simulation();
+
+    SimConfig config;
+
+    Player player;
+
+    // Player and ship bullets
+    BulletPool bullets;
+
+    ShipStore ships;
+    HouseStore houses;
+
+    // Counts simulation ticks, one per step(), see SimTimer. Nothing is
+    // polled, each gate is a timer that fires once it is due.
+    TimerWheel timers{ TIMER_COUNT };
+    // Tick the current fleet step and volley delays started at. Both
+    // delays follow harder(), so they are timed again from here when it
+    // changes.
+    uint64_t fleetStepSince = 0;
+    uint64_t volleySince = 0;
+    bool isGraceOver = false;
+    bool canShoot = true;
+
+    int score = 0;
+    int round = 1;
+
+    bool isGameOver = false;
+
+    // Picks which ships fire, seeded by make()
+    Random rng;
+
+    // Apply new tunables, drops all bullets in flight and the cached waves
+    void setConfig(const SimConfig& newConfig);
+
+    // New game, the seed decides everything random in it
+    void make(uint64_t seed = 0);
+    void startNewRound();
+
+    // Continue after a cleared round
+    void nextRound();
+
+    // Remove every ship at once
+    void clearFleet();
+
+    // Ships only know their offset in the fleet, this is where they are
+    sf::Vector2f shipPosition(int shipId) const {
+        return formation.getOrigin() + ships.position[shipId];
+    }
+    sf::Vector2f fleetOrigin() const { return formation.getOrigin(); }
+
+    // Advance the game by one tick of dt seconds. Movement follows dt, the
+    // timers count ticks as FIXED_DT each.
+    void step(const InputFrame& input, float dt);
+
+    // Whole game state as a binary snapshot, see SaveFile.hpp.
+    // Loading fails without changing anything if the snapshot is damaged,
+    // holds lives out of range or more bullets than the bullet caps allow.
+    std::vector<char> saveSnapshot() const;
+    bool loadSnapshot(const char* data, size_t size);
+
+    bool saveGame(const std::string& path) const;
+    bool loadGame(const std::string& path);
+
+private:
+    // Grid over the slots of layout, in formation space
+    void buildShipGrid(const FormationIndex& layout, SpatialGrid& grid);
+
+    // Puts the fleet for the current round in place, see WaveBlueprint
+    void spawnFleet();
+    WaveBlueprint buildWave(int round);
+
+    // Lower the time needed for ships to shoot and move
+    float harder() const;
+
+    // Starts the fleet's timers unless they are pending already and times
+    // the pending ones again from when they started, for the current
+    // harder(). Called whenever harder() may have changed.
+    void scheduleFleet();
+    void startFleetTimer(int timer);
+    // Length of the fleet step or volley delay in ticks
+    int fleetDelay(int timer) const;
+    void fireTimer(int timer, const FrameVector<int>& shooters);
+    void fireVolley(const FrameVector<int>& shooters);
+
+    // Moves one owner's bullets. The ones that left the screen are only
+    // dropped after the hit passes, their last move may still have hit.
+    void moveBullets(BulletOwner who, float dt);
+    void dropGoneBullets(BulletOwner who);
+
+    // Applies one owner's bullets to the houses, used by both player and ship bullets.
+    // A bullet hits the house its path of the last dt seconds enters first.
+    void bulletsHitHouses(BulletOwner who, float dt);
+    void buildHouseGrid();
+
+    // Broadphase for the bullet passes, one cell per ship slot of the fleet.
+    // The ship grid is in formation space, see buildShipGrid()
+    SpatialGrid shipGrid{ SHIP_CELL_SIZE };
+    SpatialGrid houseGrid{ sf::Vector2f(HOUSE_SIZE.x + HOUSE_MARGIN_X * 3, HOUSE_SIZE.y) };
+
+    // Holds every scratch buffer of a tick, so a tick never touches the
+    // heap once the arena has grown to fit
+    FrameArena scratch{ SCRATCH_BYTES };
+
+    FormationIndex formation;
+    std::unique_ptr<JobSystem> jobs;
+
+    // The most recently used blueprints, newest first, at most
+    // WAVE_CACHE_SIZE of them
+    std::vector<WaveBlueprint> waves;
+};
@@ -0,0 +1,102 @@
+#include "SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(const sf::Vector2f& cellSize)
+    : cellSize(cellSize), activeCellSize(cellSize), origin(0, 0), extent(0, 0), columns(0), rows(0) {}
+
+void SpatialGrid::build(const sf::FloatRect* newBoxes, size_t count) {
+    boxes.assign(newBoxes, newBoxes + count);
+    items.clear();
+
+    if (boxes.empty()) {
+        columns = 0;
+        rows = 0;
+        return;
+    }
+
+    // The grid only covers the area the boxes take up
+    float left = boxes[0].left;
+    float top = boxes[0].top;
+    float right = boxes[0].left + boxes[0].width;
+    float bottom = boxes[0].top + boxes[0].height;
+    for (const auto& box : boxes) {
+        left = std::min(left, box.left);
+        top = std::min(top, box.top);
+        right = std::max(right, box.left + box.width);
+        bottom = std::max(bottom, box.top + box.height);
+    }
+
+    origin = sf::Vector2f(left, top);
+    extent = sf::Vector2f(right, bottom);
+    sf::Vector2f size = cellSize;
+
+    // A few stray boxes far away should not blow up the cell count
+    size_t maxCells = boxes.size() * 4 + 64;
+    while (true) {
+        columns = std::max(1, static_cast<int>(std::ceil((right - left) / size.x)));
+        rows = std::max(1, static_cast<int>(std::ceil((bottom - top) / size.y)));
+        if (static_cast<size_t>(columns) * rows <= maxCells) break;
+        size.x *= 2;
+        size.y *= 2;
+    }
+    activeCellSize = size;
+
+    // Counting sort of the boxes into their cells
+    cellStart.assign(columns * rows + 1, 0);
+
+    int col0, row0, col1, row1;
+    for (const auto& box : boxes) {
+        cellRange(AabbQuery(box), col0, row0, col1, row1);
+        for (int row = row0; row <= row1; row++) {
+            for (int col = col0; col <= col1; col++) {
+                cellStart[row * columns + col + 1]++;
+            }
+        }
+    }
+
+    for (int cell = 0; cell < columns * rows; cell++) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+
+    items.resize(cellStart[columns * rows]);
+    cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+
+    for (int id = 0; id < static_cast<int>(boxes.size()); id++) {
+        cellRange(AabbQuery(boxes[id]), col0, row0, col1, row1);
+        for (int row = row0; row <= row1; row++) {
+            for (int col = col0; col <= col1; col++) {
+                items[cellFill[row * columns + col]++] = id;
+            }
+        }
+    }
+
+    // Edges of every item in cell order, so a cell's boxes can be tested
+    // AABB_LANES at a time. The padding is never counted as a hit.
+    size_t padded = items.size() + AABB_LANES;
+    minX.resize(padded);
+    minY.resize(padded);
+    maxX.resize(padded);
+    maxY.resize(padded);
+    for (size_t i = 0; i < items.size(); i++) {
+        AabbQuery edges(boxes[items[i]]);
+        minX[i] = edges.minX;
+        minY[i] = edges.minY;
+        maxX[i] = edges.maxX;
+        maxY[i] = edges.maxY;
+    }
+}
+
+void SpatialGrid::cellRange(const AabbQuery& edges, int& col0, int& row0, int& col1, int& row1) const {
+    // Anything outside of the grid is clamped onto its border cells
+    col0 = static_cast<int>(std::floor((edges.minX - origin.x) / activeCellSize.x));
+    row0 = static_cast<int>(std::floor((edges.minY - origin.y) / activeCellSize.y));
+    col1 = static_cast<int>(std::floor((edges.maxX - origin.x) / activeCellSize.x));
+    row1 = static_cast<int>(std::floor((edges.maxY - origin.y) / activeCellSize.y));
+
+    col0 = std::min(std::max(col0, 0), columns - 1);
+    row0 = std::min(std::max(row0, 0), rows - 1);
+    col1 = std::min(std::max(col1, 0), columns - 1);
+    row1 = std::min(std::max(row1, 0), rows - 1);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "AabbKernel.hpp"
+#include "SweptAabb.hpp"
+
+// A box hit by a path and where along the path it was hit
+struct SweptHit {
+    int id = -1;
+    float entry = SWEEP_MISS;
+};
+
+// Uniform grid over a set of boxes, rebuilt from scratch whenever they move.
+// A query only looks at the boxes stored in the cells its rectangle covers,
+// so hit tests stay cheap no matter how many boxes there are. The boxes of a
+// cell are tested several at once, see AabbKernel.hpp.
+//
+// Cells are stored packed (cellStart + items) and every buffer keeps its
+// capacity between builds, so rebuilding each tick does not allocate.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(const sf::Vector2f& cellSize);
+
+    // Replace the contents with the given boxes, a box's id is its index
+    void build(const sf::FloatRect* newBoxes, size_t count);
+    void build(const std::vector<sf::FloatRect>& newBoxes) { build(newBoxes.data(), newBoxes.size()); }
+
+    // The box the path enters first for which accept(id) is true, the
+    // lowest id of those it enters at the same time. The id is -1 when the
+    // path enters none.
+    template <typename Accept>
+    SweptHit findEarliest(const SweptAabb& path, Accept accept) const {
+        SweptHit best;
+        if (columns == 0) return best;
+
+        // Boxes the path passes over are only candidates, the entry time
+        // decides whether and when it hits them
+        AabbQuery query = path.bounds();
+        if (query.minX >= extent.x || query.maxX <= origin.x || query.minY >= extent.y || query.maxY <= origin.y) {
+            return best;
+        }
+        int col0, row0, col1, row1;
+        cellRange(query, col0, row0, col1, row1);
+
+        AabbKernel overlap = aabbKernel();
+
+        for (int row = row0; row <= row1; row++) {
+            for (int col = col0; col <= col1; col++) {
+                int cell = row * columns + col;
+                int end = cellStart[cell + 1];
+
+                for (int first = cellStart[cell]; first < end; first += AABB_LANES) {
+                    uint32_t hits = overlap(query, &minX[first], &minY[first], &maxX[first], &maxY[first])
+                        & laneMask(end - first);
+                    for (; hits != 0; hits &= hits - 1) {
+                        int item = first + lowestBit(hits);
+                        int id = items[item];
+                        float entry = path.entry(minX[item], minY[item], maxX[item], maxY[item]);
+                        bool isEarlier = entry < best.entry || (entry == best.entry && id < best.id);
+                        if (entry != SWEEP_MISS && isEarlier && accept(id)) {
+                            best.id = id;
+                            best.entry = entry;
+                        }
+                    }
+                }
+            }
+        }
+
+        return best;
+    }
+
+private:
+    void cellRange(const AabbQuery& edges, int& col0, int& row0, int& col1, int& row1) const;
+
+    sf::Vector2f cellSize;
+    sf::Vector2f activeCellSize;
+    sf::Vector2f origin;
+    // Right and bottom edge of the boxes
+    sf::Vector2f extent;
+    int columns;
+    int rows;
+
+    std::vector<sf::FloatRect> boxes;
+    std::vector<int> cellStart;
+    std::vector<int> items;
+    std::vector<int> cellFill;
+
+    // Per item, the edges of its box, see AabbKernel.hpp
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+};
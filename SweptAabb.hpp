@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+#include "AabbKernel.hpp"
+
+// Returned by SweptAabb::entry when the path misses the box
+const float SWEEP_MISS = 2.f;
+
+// A box moving in a straight line over one tick, from start to
+// start + delta. Testing only where it ends up lets a fast box skip over a
+// thin one when the tick is long, testing the path does not.
+struct SweptAabb {
+    AabbQuery start;
+    sf::Vector2f delta;
+
+    SweptAabb(const sf::FloatRect& startRect, const sf::Vector2f& delta)
+        : start(startRect), delta(delta) {}
+
+    // Everything the box passes over, for the broadphase
+    AabbQuery bounds() const {
+        return AabbQuery(
+            std::min(start.minX, start.minX + delta.x), std::min(start.minY, start.minY + delta.y),
+            std::max(start.maxX, start.maxX + delta.x), std::max(start.maxY, start.maxY + delta.y));
+    }
+
+    // Share of the move, 0 to 1, at which the box first overlaps the given
+    // one, or SWEEP_MISS if it never does. Touching edges do not count, the
+    // same as for AabbQuery.
+    float entry(float minX, float minY, float maxX, float maxY) const {
+        float enter = -1.f;
+        float exit = SWEEP_MISS;
+        if (!clipAxis(start.minX, start.maxX, delta.x, minX, maxX, enter, exit)) return SWEEP_MISS;
+        if (!clipAxis(start.minY, start.maxY, delta.y, minY, maxY, enter, exit)) return SWEEP_MISS;
+
+        if (enter >= exit || enter >= 1.f || exit <= 0.f) return SWEEP_MISS;
+        return std::max(enter, 0.f);
+    }
+
+private:
+    // Narrows enter and exit to the times at which the moving span
+    // [from, to] overlaps [boxMin, boxMax], false if it never does
+    static bool clipAxis(float from, float to, float move, float boxMin, float boxMax, float& enter, float& exit) {
+        if (move == 0.f) return from < boxMax && to > boxMin;
+
+        float first = (boxMin - to) / move;
+        float last = (boxMax - from) / move;
+        if (move < 0.f) std::swap(first, last);
+
+        enter = std::max(enter, first);
+        exit = std::min(exit, last);
+        return true;
+    }
+};
@@ -0,0 +1,55 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel(int timerCount)
+    : timers(timerCount) {
+    due.reserve(timerCount);
+}
+
+void TimerWheel::schedule(int timer, int ticks) {
+    if (isPending(timer)) unlink(timer);
+
+    Timer& entry = timers[timer];
+    entry.due = now + std::max(ticks, 1);
+
+    Slot& slot = slots[entry.due % WHEEL_SLOTS];
+    entry.previous = slot.last;
+    entry.next = NONE;
+    if (slot.last != NONE) {
+        timers[slot.last].next = timer;
+    } else {
+        slot.first = timer;
+    }
+    slot.last = timer;
+}
+
+void TimerWheel::cancel(int timer) {
+    if (!isPending(timer)) return;
+    unlink(timer);
+    timers[timer].due = IDLE;
+}
+
+void TimerWheel::cancelAll() {
+    for (int timer = 0; timer < static_cast<int>(timers.size()); timer++) {
+        cancel(timer);
+    }
+}
+
+void TimerWheel::unlink(int timer) {
+    Timer& entry = timers[timer];
+    Slot& slot = slots[entry.due % WHEEL_SLOTS];
+
+    if (entry.previous != NONE) {
+        timers[entry.previous].next = entry.next;
+    } else {
+        slot.first = entry.next;
+    }
+    if (entry.next != NONE) {
+        timers[entry.next].previous = entry.previous;
+    } else {
+        slot.last = entry.previous;
+    }
+    entry.previous = NONE;
+    entry.next = NONE;
+}
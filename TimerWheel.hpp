@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Fires timers after a number of ticks. Time only moves when advance() is
+// called, once per simulation tick, so timers follow the game and not the
+// wall clock: a paused game that is not stepped does not fire anything.
+//
+// There is a fixed set of timers, numbered from 0, and each one is either
+// pending once or idle. Scheduling a pending timer moves it. Pending timers
+// hang in one of WHEEL_SLOTS lists picked by their due tick, so a tick only
+// looks at the timers in its own slot and advancing costs the same however
+// many timers are pending. Timers due on the same tick fire in the order
+// of their numbers, however they were scheduled.
+class TimerWheel {
+public:
+    static const int WHEEL_SLOTS = 256;
+
+    explicit TimerWheel(int timerCount);
+
+    // Due in the given number of ticks, at least 1
+    void schedule(int timer, int ticks);
+    void cancel(int timer);
+    void cancelAll();
+
+    bool isPending(int timer) const { return timers[timer].due != IDLE; }
+    // Ticks until the timer fires, -1 if it is idle
+    int remaining(int timer) const {
+        return isPending(timer) ? static_cast<int>(timers[timer].due - now) : -1;
+    }
+
+    // Ticks advanced so far
+    uint64_t tick() const { return now; }
+
+    // Moves to the next tick and calls fire(timer) for every timer that is
+    // due then. fire may schedule and cancel timers, the ones it schedules
+    // fire on a later tick at the earliest.
+    template <typename Fire>
+    void advance(Fire fire) {
+        now++;
+
+        due.clear();
+        Slot& slot = slots[now % WHEEL_SLOTS];
+        for (int timer = slot.first; timer != NONE;) {
+            int next = timers[timer].next;
+            if (timers[timer].due == now) {
+                unlink(timer);
+                timers[timer].due = IDLE;
+                due.push_back(timer);
+            }
+            timer = next;
+        }
+        std::sort(due.begin(), due.end());
+
+        for (int timer : due) {
+            fire(timer);
+        }
+    }
+
+private:
+    static const int NONE = -1;
+    static const uint64_t IDLE = UINT64_MAX;
+
+    struct Timer {
+        uint64_t due = IDLE;
+        int previous = NONE;
+        int next = NONE;
+    };
+
+    struct Slot {
+        int first = NONE;
+        int last = NONE;
+    };
+
+    void unlink(int timer);
+
+    uint64_t now = 0;
+    std::vector<Timer> timers;
+    Slot slots[WHEEL_SLOTS];
+
+    // Timers that fire on the current tick, sized once for all of them
+    std::vector<int> due;
+};
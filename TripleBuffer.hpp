@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands values from one writer thread to one reader thread without locks.
+// The writer fills back() and publishes it, the reader picks up the newest
+// published value with update(). Neither side ever waits for the other,
+// and a value being read is never written to.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side. True if a newer value replaced front().
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const uint8_t INDEX = 3;
+    static const uint8_t FRESH = 4;
+
+    T slots[3];
+    uint8_t backIndex = 0;
+    std::atomic<uint8_t> middle{ 1 };
+    uint8_t frontIndex = 2;
+};
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bots.hpp"
+#include "CommandLine.hpp"
+#include "Simulation.hpp"
+
+// Plays many seeded games at once, one per core, each driven by a bot, and
+// sums them up per round as CSV, for tuning the difficulty. Game i is
+// played with seed + i, so the output does not depend on the thread count.
+//
+//   ./infa_batch [--games 1000] [--seed 1] [--bot sweep] [--threads n]
+//                [--max-ticks n] [--out rounds.csv]
+//                [--extra-ships n] [--harder-per-round x] [--max-harder x]
+
+namespace {
+
+const char* const USAGE =
+    "usage: infa_batch [--games 1000] [--seed 1] [--bot sweep] [--threads n]\n"
+    "                  [--max-ticks n] [--out rounds.csv]\n"
+    "                  [--extra-ships n] [--harder-per-round x] [--max-harder x]\n";
+
+struct GameResult {
+    int roundsCleared = 0;
+    int score = 0;
+    int ticks = 0;
+    // Per cleared round
+    std::vector<int> clearTicks;
+    std::vector<int> scoreAtClear;
+};
+
+// One game from make() until it is lost or maxTicks ran out
+void playGame(Simulation& sim, Bot bot, uint64_t seed, int maxTicks, GameResult& result) {
+    sim.make(seed);
+
+    int roundStart = 0;
+    int tick = 0;
+    while (tick < maxTicks && !sim.isGameOver) {
+        sim.step(bot(sim, tick), FIXED_DT);
+        tick++;
+
+        if (sim.ships.empty()) {
+            result.clearTicks.push_back(tick - roundStart);
+            result.scoreAtClear.push_back(sim.score);
+            result.roundsCleared++;
+            sim.nextRound();
+            roundStart = tick;
+        }
+    }
+
+    result.score = sim.score;
+    result.ticks = tick;
+}
+
+double seconds(int ticks) {
+    return ticks * FIXED_DT;
+}
+
+// Value below which the given share of the sorted values lies
+double percentile(const std::vector<int>& sorted, double share) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * share))];
+}
+
+// One row per round: how many games got there and cleared it, how long
+// clearing took and the score at that point
+std::string roundsCsv(const std::vector<GameResult>& games) {
+    int lastRound = 0;
+    for (const auto& game : games) {
+        lastRound = std::max(lastRound, game.roundsCleared + 1);
+    }
+
+    std::ostringstream out;
+    out << "round,games_reached,games_cleared,clear_rate,mean_clear_s,p50_clear_s,p90_clear_s,mean_score_at_clear\n";
+    for (int round = 1; round <= lastRound; round++) {
+        int reached = 0;
+        std::vector<int> clearTicks;
+        double scoreSum = 0;
+        for (const auto& game : games) {
+            if (game.roundsCleared + 1 >= round) reached++;
+            if (game.roundsCleared >= round) {
+                clearTicks.push_back(game.clearTicks[round - 1]);
+                scoreSum += game.scoreAtClear[round - 1];
+            }
+        }
+        std::sort(clearTicks.begin(), clearTicks.end());
+
+        double tickSum = 0;
+        for (int ticks : clearTicks) tickSum += ticks;
+        int cleared = static_cast<int>(clearTicks.size());
+
+        out << round << ',' << reached << ',' << cleared
+            << ',' << (reached > 0 ? static_cast<double>(cleared) / reached : 0)
+            << ',' << (cleared > 0 ? seconds(1) * tickSum / cleared : 0)
+            << ',' << seconds(1) * percentile(clearTicks, 0.5)
+            << ',' << seconds(1) * percentile(clearTicks, 0.9)
+            << ',' << (cleared > 0 ? scoreSum / cleared : 0)
+            << '\n';
+    }
+    return out.str();
+}
+
+}
+
+int main(int argc, char** argv) {
+    int games = 1000;
+    uint64_t seed = 1;
+    std::string botName = "sweep";
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    // Half an hour of play
+    int maxTicks = 60 * 60 * 30;
+    std::string outPath;
+    SimConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            if (!parseInt(argv[++i], games, 1)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseUint64(argv[++i], seed)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--bot" && i + 1 < argc) {
+            botName = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseInt(argv[++i], threads, 1)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--max-ticks" && i + 1 < argc) {
+            if (!parseInt(argv[++i], maxTicks, 1)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--extra-ships" && i + 1 < argc) {
+            if (!parseInt(argv[++i], config.extraShipsPerRound, 0)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--harder-per-round" && i + 1 < argc) {
+            if (!parseFloat(argv[++i], config.harderPerRound)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--max-harder" && i + 1 < argc) {
+            if (!parseFloat(argv[++i], config.maxHarder)) return badOption(arg, argv[i], USAGE);
+        }
+    }
+
+    Bot bot = findBot(botName);
+    if (bot == nullptr) {
+        std::cerr << "Unknown bot " << botName << ", one of:" << std::endl;
+        for (int i = 0; i < BOT_COUNT; i++) {
+            std::cerr << "  " << BOTS[i].name << "  " << BOTS[i].description << std::endl;
+        }
+        return 1;
+    }
+
+    // Games are handed out one at a time, so a long game on one thread
+    // does not hold up the others
+    std::vector<GameResult> results(games);
+    std::atomic<int> nextGame{ 0 };
+    auto worker = [&]() {
+        Simulation sim;
+        sim.setConfig(config);
+        for (int game = nextGame++; game < games; game = nextGame++) {
+            playGame(sim, bot, seed + game, maxTicks, results[game]);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double roundsSum = 0, scoreSum = 0, ticksSum = 0;
+    for (const auto& game : results) {
+        roundsSum += game.roundsCleared;
+        scoreSum += game.score;
+        ticksSum += game.ticks;
+    }
+
+    std::cerr << "games: " << games << " on " << threads << " threads, bot " << botName << std::endl;
+    std::cerr << "seconds: " << elapsed.count() << std::endl;
+    std::cerr << "games/s: " << (elapsed.count() > 0 ? games / elapsed.count() : 0) << std::endl;
+    if (games > 0) {
+        std::cerr << "mean rounds cleared: " << roundsSum / games << std::endl;
+        std::cerr << "mean score: " << scoreSum / games << std::endl;
+        std::cerr << "mean game length s: " << seconds(1) * ticksSum / games << std::endl;
+    }
+
+    std::string csv = roundsCsv(results);
+    if (outPath.empty()) {
+        std::cout << csv;
+        return 0;
+    }
+
+    std::ofstream outFile(outPath, std::ios::trunc);
+    outFile << csv;
+    if (!outFile) {
+        std::cerr << "Could not write " << outPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AabbKernel.hpp"
+#include "BulletPool.hpp"
+#include "CommandLine.hpp"
+#include "Profiler.hpp"
+#include "Random.hpp"
+#include "Simulation.hpp"
+
+// Benchmarks the hot paths of the simulation at growing fleet sizes and
+// prints the results as JSON, so runs from two commits can be diffed.
+//
+//   ./infa_bench [--sizes 50,500,5000,50000] [--time seconds] [--threads n]
+//                [--kernel scalar|sse2|avx2] [--out file.json]
+
+namespace {
+
+const char* const USAGE =
+    "usage: infa_bench [--sizes 50,500,5000,50000] [--time seconds] [--threads n]\n"
+    "                  [--kernel scalar|sse2|avx2] [--out file.json]\n";
+
+const int BENCH_PLAYER_BULLETS = 500;
+const int BENCH_SHIP_BULLETS = 500;
+const size_t MIN_RUNS = 5;
+const size_t MAX_RUNS = 1000;
+// Rectangles tested against every box by the narrowphase benchmarks
+const int NARROWPHASE_QUERIES = 64;
+
+struct Result {
+    std::string name;
+    int ships;
+    std::vector<double> samples;    // nanoseconds per iteration
+};
+
+using Clock = std::chrono::steady_clock;
+
+double nanosecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// First round with at least that many ships, see Simulation::buildWave()
+int roundForShips(int ships, const SimConfig& config) {
+    if (config.extraShipsPerRound <= 0) return 1;
+    int extraShips = std::max(ships - FIRST_ROUND_SHIPS, 0);
+    return (extraShips + config.extraShipsPerRound - 1) / config.extraShipsPerRound + 1;
+}
+
+// A game with the given fleet, past the grace time so the ships shoot
+void makeGame(Simulation& sim, int ships, int threads) {
+    SimConfig config;
+    config.maxPlayerBullets = BENCH_PLAYER_BULLETS;
+    config.maxShipBullets = BENCH_SHIP_BULLETS;
+    config.threads = threads;
+    sim.setConfig(config);
+
+    sim.make(1);
+    sim.round = roundForShips(ships, config);
+    sim.startNewRound();
+    sim.isGraceOver = true;
+}
+
+// Player bullets right under the lowest ships and ship bullets right over
+// the houses and the player, so every collision pass has hits to resolve
+void fillBullets(Simulation& sim, Random& rng) {
+    int lowest = std::min<int>(sim.ships.size(), 200);
+    for (int i = 0; i < BENCH_PLAYER_BULLETS && lowest > 0; i++) {
+        int shipId = sim.ships.size() - 1 - rng.nextInt(lowest);
+        sf::Vector2f position = sim.shipPosition(shipId) + sf::Vector2f(SHIP_SIZE.x / 2.f, SHIP_SIZE.y / 2.f);
+        sim.bullets.spawn(position, sf::Vector2f(0, -BULLET_SPEED), BulletOwner::Player);
+    }
+
+    for (int i = 0; i < BENCH_SHIP_BULLETS; i++) {
+        sf::Vector2f position = sim.player.getShape().getPosition();
+        if (!sim.houses.empty() && i % 4 != 0) {
+            position = sim.houses.position[rng.nextInt(sim.houses.size())];
+        }
+        sim.bullets.spawn(position - sf::Vector2f(0, BULLET_SIZE.y), sf::Vector2f(0, BULLET_SPEED), BulletOwner::Ship);
+    }
+}
+
+// Runs setup (untimed) and body (timed by the body itself) until the time
+// budget is used up, but at least MIN_RUNS and at most MAX_RUNS times
+class Bench {
+public:
+    explicit Bench(double seconds) : budget(seconds) {}
+
+    void run(const std::string& name, int ships,
+        const std::function<void()>& setup, const std::function<double()>& body) {
+        Result result{ name, ships, {} };
+
+        setup();
+        body();     // warm up
+
+        auto start = Clock::now();
+        while (result.samples.size() < MIN_RUNS ||
+            (result.samples.size() < MAX_RUNS && nanosecondsSince(start) < budget * 1e9)) {
+            setup();
+            result.samples.push_back(body());
+        }
+
+        std::cerr << name << " (" << ships << " ships): " << result.samples.size() << " runs" << std::endl;
+        results.push_back(std::move(result));
+    }
+
+    std::string json() const {
+        std::ostringstream out;
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            std::vector<double> sorted = results[i].samples;
+            std::sort(sorted.begin(), sorted.end());
+
+            double total = 0;
+            for (double sample : sorted) total += sample;
+
+            out << "    { \"name\": \"" << results[i].name << "\""
+                << ", \"ships\": " << results[i].ships
+                << ", \"runs\": " << sorted.size()
+                << ", \"median_ns\": " << sorted[sorted.size() / 2]
+                << ", \"mean_ns\": " << total / sorted.size()
+                << ", \"min_ns\": " << sorted.front()
+                << ", \"max_ns\": " << sorted.back()
+                << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return out.str();
+    }
+
+private:
+    double budget;
+    std::vector<Result> results;
+};
+
+void benchSize(Bench& bench, int ships, int threads) {
+    Simulation sim;
+    Random rng(ships);
+
+    makeGame(sim, ships, threads);
+    fillBullets(sim, rng);
+    std::vector<char> start = sim.saveSnapshot();
+    auto restore = [&]() { sim.loadSnapshot(start.data(), start.size()); };
+
+    InputFrame input;
+    input.moveDir = 1;
+    input.shoot = true;
+
+    // Collision and shooter selection are phases of one step, the profiler
+    // tells them apart
+    auto stepPhases = [&](std::vector<int> phases) {
+        return [&, phases]() {
+            profiler().beginFrame();
+            sim.step(input, FIXED_DT);
+            profiler().endFrame();
+
+            double total = 0;
+            for (int phase : phases) total += profiler().lastFrame(phase);
+            return total;
+        };
+    };
+
+    profiler().setEnabled(true);
+    bench.run("collision", ships, restore,
+        stepPhases({ PHASE_SHIP_HITS, PHASE_PLAYER_HOUSE_HITS, PHASE_SHIP_HOUSE_HITS, PHASE_PLAYER_HITS }));
+    bench.run("shooter_selection", ships, restore, stepPhases({ PHASE_SHOOTERS }));
+    profiler().setEnabled(false);
+
+    // A full pool filled and emptied in random order
+    BulletPool pool;
+    pool.setCapacity(ships, ships);
+    bench.run("bullet_spawn_despawn", ships, []() {}, [&]() {
+        auto begin = Clock::now();
+        for (int i = 0; i < ships; i++) {
+            pool.spawn(sf::Vector2f(i, i), sf::Vector2f(0, -BULLET_SPEED), i % 2 ? BulletOwner::Ship : BulletOwner::Player);
+        }
+        while (pool.size() > 0) {
+            pool.remove(rng.nextInt(pool.size()));
+        }
+        return nanosecondsSince(begin);
+    });
+
+    bench.run("start_new_round", ships, restore, [&]() {
+        auto begin = Clock::now();
+        sim.startNewRound();
+        return nanosecondsSince(begin);
+    });
+
+    bench.run("save", ships, restore, [&]() {
+        auto begin = Clock::now();
+        std::vector<char> snapshot = sim.saveSnapshot();
+        double time = nanosecondsSince(begin);
+        return snapshot.empty() ? 0 : time;
+    });
+
+    bench.run("load", ships, []() {}, [&]() {
+        auto begin = Clock::now();
+        sim.loadSnapshot(start.data(), start.size());
+        return nanosecondsSince(begin);
+    });
+
+    // One bullet sized rectangle against every box, as the passes did it
+    // one pair at a time and as the kernels do it. Every level the CPU
+    // runs is timed, whatever --kernel picked.
+    std::vector<sf::FloatRect> boxes;
+    std::vector<float> minX, minY, maxX, maxY;
+    for (int i = 0; i < ships; i++) {
+        sf::FloatRect box(rng.nextInt(800), rng.nextInt(600), SHIP_SIZE.x, SHIP_SIZE.y);
+        AabbQuery edges(box);
+        boxes.push_back(box);
+        minX.push_back(edges.minX);
+        minY.push_back(edges.minY);
+        maxX.push_back(edges.maxX);
+        maxY.push_back(edges.maxY);
+    }
+    for (int lane = 0; lane < AABB_LANES; lane++) {
+        minX.push_back(0);
+        minY.push_back(0);
+        maxX.push_back(0);
+        maxY.push_back(0);
+    }
+    std::vector<sf::FloatRect> queries;
+    for (int i = 0; i < NARROWPHASE_QUERIES; i++) {
+        queries.push_back(sf::FloatRect(rng.nextInt(800), rng.nextInt(600), BULLET_SIZE.x, BULLET_SIZE.y));
+    }
+
+    std::vector<uint8_t> hits(ships);
+    int pairHits = 0;
+    bench.run("narrowphase_per_pair", ships, []() {}, [&]() {
+        auto begin = Clock::now();
+        for (const auto& query : queries) {
+            for (int i = 0; i < ships; i++) {
+                hits[i] = query.intersects(boxes[i]);
+            }
+            pairHits += hits[ships - 1];
+        }
+        return nanosecondsSince(begin);
+    });
+
+    AabbKernelLevel picked = aabbKernelLevel();
+    for (AabbKernelLevel level : { AabbKernelLevel::Scalar, AabbKernelLevel::Sse2, AabbKernelLevel::Avx2 }) {
+        if (!setAabbKernelLevel(level)) continue;
+
+        bench.run(std::string("narrowphase_") + aabbKernelName(level), ships, []() {}, [&]() {
+            auto begin = Clock::now();
+            for (const auto& query : queries) {
+                overlapAll(AabbQuery(query), minX.data(), minY.data(), maxX.data(), maxY.data(), ships, hits.data());
+                pairHits += hits[ships - 1];
+            }
+            return nanosecondsSince(begin);
+        });
+    }
+    setAabbKernelLevel(picked);
+
+    // Keeps the loops above from being optimised away
+    if (pairHits < 0) std::cerr << pairHits << std::endl;
+
+    // Back to back steps of a game in play, the way the window drives it
+    makeGame(sim, ships, threads);
+    std::vector<char> fresh = sim.saveSnapshot();
+    int tick = 0;
+    bench.run("frame", ships, [&]() {
+        if (sim.ships.empty() || sim.isGameOver) {
+            sim.loadSnapshot(fresh.data(), fresh.size());
+        }
+    }, [&]() {
+        input.moveDir = (tick++ / 120) % 2 == 0 ? 1 : -1;
+        auto begin = Clock::now();
+        sim.step(input, FIXED_DT);
+        return nanosecondsSince(begin);
+    });
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = { 50, 500, 5000, 50000 };
+    double seconds = 0.2;
+    int threads = 1;
+    std::string outPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            // Every benchmark needs at least one ship
+            sizes.clear();
+            std::istringstream list(argv[++i]);
+            std::string size;
+            while (std::getline(list, size, ',')) {
+                int ships = 0;
+                if (!parseInt(size.c_str(), ships, 1)) return badOption(arg, argv[i], USAGE);
+                sizes.push_back(ships);
+            }
+            if (sizes.empty()) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--time" && i + 1 < argc) {
+            float time = 0;
+            if (!parseFloat(argv[++i], time, 0)) return badOption(arg, argv[i], USAGE);
+            seconds = time;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseInt(argv[++i], threads, 1)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--kernel" && i + 1 < argc) {
+            std::string name = argv[++i];
+            bool picked = false;
+            for (AabbKernelLevel level : { AabbKernelLevel::Scalar, AabbKernelLevel::Sse2, AabbKernelLevel::Avx2 }) {
+                if (name == aabbKernelName(level)) {
+                    picked = setAabbKernelLevel(level);
+                }
+            }
+            if (!picked) {
+                std::cerr << "Kernel " << name << " is not supported here" << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cerr << "aabb kernel: " << aabbKernelName(aabbKernelLevel()) << std::endl;
+
+    Bench bench(seconds);
+    for (int ships : sizes) {
+        benchSize(bench, ships, threads);
+    }
+
+    if (outPath.empty()) {
+        std::cout << bench.json();
+        return 0;
+    }
+
+    std::ofstream outFile(outPath, std::ios::trunc);
+    outFile << bench.json();
+    if (!outFile) {
+        std::cerr << "Could not write " << outPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,123 +1,102 @@
+#include <algorithm>
 #include <iostream>
 #include <SFML/Graphics.hpp>
 #include <functional>
 #include <vector>
+#include <string>
+#include <chrono>
 #include <random>
-#include <fstream>
+
+#include "AllocationTracker.hpp"
+#include "BatchRenderer.hpp"
+#include "Bots.hpp"
+#include "CachedLayer.hpp"
+#include "CommandLine.hpp"
+#include "FramePacer.hpp"
+#include "Hud.hpp"
+#include "Menu.hpp"
+#include "Profiler.hpp"
+#include "Replay.hpp"
+#include "SaveService.hpp"
+#include "SimThread.hpp"
+#include "Simulation.hpp"
 
 // Save Game
 // choose difficulty
 
-const sf::Vector2f WINDOW_SIZE = sf::Vector2f(800, 600);
+const std::string SAVE_PATH = "save.dat";
+
+const char* const USAGE =
+    "usage: infa [--headless] [--ticks n] [--seed n] [--threads n]\n"
+    "            [--player-bullets n] [--ship-bullets n] [--check-allocations]\n"
+    "            [--record file] [--replay file] [--from tick]\n"
+    "            [--profile file.csv] [--fps n]\n";
 
-class Button {
+// p50 / p99 / max of every phase over the last frames, toggled with F3.
+// The simulation thread's ticks and the window's frames are timed apart.
+// Builds that track allocations also show the most any frame made.
+class ProfileOverlay {
 private:
-    sf::RectangleShape shape;
-    sf::Text text;
-    std::function<void()> callback;
-    bool isHovered;
+    sf::RectangleShape background;
+    sf::Text columns[5];
+    uint32_t shownFrame = 0;
 
-public:
-    Button(const sf::Vector2f& position, const sf::Vector2f& size,
-        const std::string& buttonText, const sf::Font& font,
-        std::function<void()> onClick)
-        : callback(onClick), isHovered(false) {
-
-        shape.setPosition(position);
-        shape.setSize(size);
-        shape.setFillColor(sf::Color(100, 100, 100));
-        shape.setOutlineThickness(2);
-        shape.setOutlineColor(sf::Color::White);
-
-        text.setFont(font);
-        text.setString(buttonText);
-        text.setCharacterSize(20);
-        text.setFillColor(sf::Color::White);
-
-        // Center text 
-        sf::FloatRect textBounds = text.getLocalBounds();
-        text.setOrigin(textBounds.left + textBounds.width / 2.0f,
-            textBounds.top + textBounds.height / 2.0f);
-        text.setPosition(
-            position.x + size.x / 2.0f,
-            position.y + size.y / 2.0f
-        );
-    }
+    static void addRows(std::string text[5], const std::string& title, const Profiler& source) {
+        text[0] += title + "\n";
+        for (int i = 1; i < 5; i++) text[i] += "\n";
 
-    void handleEvent(const sf::Event& event, const sf::RenderWindow& window) {
-        sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-        bool mouseOver = shape.getGlobalBounds().contains(mousePos.x, mousePos.y);
+        for (int phase = 0; phase <= PHASE_COUNT; phase++) {
+            PhaseStats stats = source.stats(phase);
+            // Phases that belong to the other thread
+            if (stats.max == 0) continue;
 
-        if (mouseOver) {
-            if (!isHovered) {
-                isHovered = true;
-                shape.setFillColor(sf::Color(150, 150, 150));
-            }
-            if (event.type == sf::Event::MouseButtonPressed &&
-                event.mouseButton.button == sf::Mouse::Left) {
-                callback();
-            }
-        } else if (isHovered) {
-            isHovered = false;
-            shape.setFillColor(sf::Color(100, 100, 100));
+            text[0] += "  " + std::string(phaseName(phase)) + "\n";
+            text[1] += std::to_string(static_cast<int>(stats.p50)) + "\n";
+            text[2] += std::to_string(static_cast<int>(stats.p99)) + "\n";
+            text[3] += std::to_string(static_cast<int>(stats.max)) + "\n";
+            text[4] += std::to_string(stats.maxAllocations) + "\n";
         }
     }
 
-    void draw(sf::RenderWindow& window) {
-        window.draw(shape);
-        window.draw(text);
-    }
-};
-
-class MenuOverlay {
-private:
-    sf::RectangleShape background;
-    std::vector<Button> buttons;
-    sf::Text titleText;
-    sf::Text scoreText;
-
 public:
-    MenuOverlay(const sf::Font& font, const std::string& title, const sf::Vector2f& windowSize) {
-        background.setSize(windowSize);
-        background.setFillColor(sf::Color(0, 0, 0, 180));
-
-        titleText.setFont(font);
-        titleText.setString(title);
-        titleText.setCharacterSize(40);
-        titleText.setFillColor(sf::Color::White);
-
-        sf::FloatRect textRect = titleText.getLocalBounds();
-        titleText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
-        titleText.setPosition(windowSize.x / 2.0f, windowSize.y / 2.0f - 150);
-    }
+    void setFont(const sf::Font& font) {
+        background.setPosition(5, 30);
+        background.setFillColor(sf::Color(0, 0, 0, 200));
 
-    void addButton(const Button& button) {
-        buttons.push_back(button);
+        const float columnX[5] = { 10, 160, 220, 280, 340 };
+        for (int i = 0; i < 5; i++) {
+            columns[i].setFont(font);
+            columns[i].setCharacterSize(13);
+            columns[i].setFillColor(sf::Color::White);
+            columns[i].setPosition(columnX[i], 35);
+        }
     }
 
-    void setScoreText(const sf::Font& font, const std::string& text) {
-        scoreText.setFont(font);
-        scoreText.setString(text);
-        scoreText.setCharacterSize(30);
-        scoreText.setFillColor(sf::Color::White);
+    void draw(sf::RenderWindow& window, const Profiler& frames, const Profiler* ticks) {
+        // Sorting the history every frame would show up in the profile itself
+        uint32_t frame = frames.frameCount();
+        if (frame - shownFrame >= 30 || shownFrame == 0) {
+            shownFrame = frame;
 
-        sf::FloatRect textRect = scoreText.getLocalBounds();
-        scoreText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
-        scoreText.setPosition(WINDOW_SIZE.x / 2.0f, WINDOW_SIZE.y / 2.0f - 80);
-    }
+            std::string text[5] = { "phase\n", "p50 us\n", "p99 us\n", "max us\n", "allocs\n" };
+            if (ticks != nullptr) {
+                addRows(text, "tick", *ticks);
+            }
+            addRows(text, "frame", frames);
 
-    void handleEvent(const sf::Event& event, const sf::RenderWindow& window) {
-        for (auto& button : buttons) {
-            button.handleEvent(event, window);
+            // Always 0 without tracking
+            if (!ALLOCATION_TRACKING) {
+                text[4].clear();
+            }
+            for (int i = 0; i < 5; i++) {
+                columns[i].setString(text[i]);
+            }
+            background.setSize(sf::Vector2f(ALLOCATION_TRACKING ? 400 : 340, columns[0].getLocalBounds().height + 20));
         }
-    }
 
-    void draw(sf::RenderWindow& window) {
         window.draw(background);
-        window.draw(titleText);
-        window.draw(scoreText);
-        for (auto& button : buttons) {
-            button.draw(window);
+        for (auto& column : columns) {
+            window.draw(column);
         }
     }
 };
@@ -132,993 +111,560 @@ enum MainMenuState {
     PlayAndLoad,
 };
 
-class Destroyable {
-protected:
-    sf::ConvexShape shape;
-    int lives;
-    int maxLives;
-public:
-    Destroyable() : lives(0), maxLives(0) {}
-    virtual ~Destroyable() = default;
-
-    virtual void updateColor() = 0;
-    virtual void setShape() = 0;
+enum Screen {
+    MainMenuScreen,
+    PlayAndLoadScreen,
+    PauseScreen,
+    PostRoundScreen,
+    GameOverScreen,
+};
 
-    void setLives(const int& num) {
-        lives = num;
-    }
+struct GameData {
+    GameData(sf::RenderWindow& window, SaveService& saves, SimThread& sim)
+        : window(window), saves(saves), sim(sim) {}
 
-    void damage(const int& num) {
-        lives -= num;
-    }
+    sf::RenderWindow& window;
+    SaveService& saves;
+    // The game itself runs on this thread, the window only sees snapshots
+    SimThread& sim;
 
-    sf::ConvexShape& getShape() {
-        return shape;
-    }
+    sf::Font font;
+    BatchRenderer renderer;
+    Hud hud;
 
-    int& getLives() {
-        return lives;
-    }
+    // The planets never move, so they are drawn from layers
+    sf::CircleShape playEarth{ 500.f, 50 };
+    sf::CircleShape menuEarth{ 250.f };
+    CachedLayer playEarthLayer;
+    CachedLayer menuEarthLayer;
 
-    int& getMaxLives() {
-        return maxLives;
-    }
-};
+    ProfileOverlay profileOverlay;
 
-struct Bullet {
-    sf::RectangleShape shape;
-};
+    float angle = 0;
+    float orbitRadius = 0;
 
-class Ship : public Destroyable {
-public:
-    Ship() {
-        lives = 1;
-        maxLives = 1;
-        this->setShape();
-    }
+    bool isPaused = false;
+    bool saveRequested = false;
+    bool showProfile = false;
+    bool isRunning = false;
 
-    void updateColor() override {
-        float healthPercent = static_cast<float>(lives) / maxLives;
-
-        if (healthPercent == 1.0f) {
-            shape.setFillColor(sf::Color::White);
-        } else if (healthPercent >= 0.8f) {
-            shape.setFillColor(sf::Color(173, 216, 230)); // Light Blue
-        } else if (healthPercent >= 0.6f) {
-            shape.setFillColor(sf::Color(144, 238, 144)); // Green
-        } else if (healthPercent >= 0.4f) {
-            shape.setFillColor(sf::Color::Yellow);
-        } else if (healthPercent >= 0.2f) {
-            shape.setFillColor(sf::Color(255, 165, 0)); // Orange
-        } else {
-            shape.setFillColor(sf::Color::Red);
-        }
-    }
+    MenuState menuState = Play;
+    MainMenuState mainState = MainMenu;
 
-    void setShape() override {
-        sf::ConvexShape convex(12);
-        // 50 x 20
-        convex.setPoint(0, sf::Vector2f(10, 0));
-        convex.setPoint(1, sf::Vector2f(0, -5));
-        convex.setPoint(2, sf::Vector2f(0, -10));
-        convex.setPoint(3, sf::Vector2f(10, -10));
-        convex.setPoint(4, sf::Vector2f(10, -15));
-        convex.setPoint(5, sf::Vector2f(15, -20));
-        convex.setPoint(6, sf::Vector2f(35, -20));
-        convex.setPoint(7, sf::Vector2f(40, -15));
-        convex.setPoint(8, sf::Vector2f(40, -10));
-        convex.setPoint(9, sf::Vector2f(50, -10));
-        convex.setPoint(10, sf::Vector2f(50, -5));
-        convex.setPoint(11, sf::Vector2f(40, 0));
-
-        shape = convex;
-    }
-};
+    // One overlay per Screen, built once by buildMenus()
+    std::vector<MenuOverlay> menus;
+    MenuOverlay* shownMenu = nullptr;
+    sf::Text saveText;
+    // What the menu texts currently say, they are only rebuilt on a change
+    int shownRound = 0;
+    int shownScore = 0;
+    SaveStatus shownSaveStatus = SaveStatus::Idle;
+
+    // Seed of the next game. Picked at random unless --seed was given,
+    // then games count up from it.
+    uint64_t nextSeed = 0;
+    bool fixedSeed = false;
+
+    // Number of the Load command the main menu waits for, 0 if none
+    uint64_t pendingLoad = 0;
+    // Number of the newest restart or next round. Snapshots from before it
+    // still show the old game, see activeMenu().
+    uint64_t screenCommand = 0;
 
-class House : public Destroyable {
-public:
-    House() {
-        lives = 8;
-        maxLives = 8;
-        this->setShape();
-    }
+    void make() {
+        std::random_device device;
+        SimCommand restart{ SimCommandType::Restart };
+        restart.seed = fixedSeed ? nextSeed++ : static_cast<uint64_t>(device()) << 32 | device();
+        screenCommand = sim.send(restart);
+        saveRequested = false;
 
-    void updateColor() override {
-        float healthPercent = static_cast<float>(lives) / maxLives;
-
-        if (healthPercent == 1.0f) {
-            shape.setFillColor(sf::Color::White);
-        } else if (healthPercent >= 0.8f) {
-            shape.setFillColor(sf::Color(173, 216, 230)); // Light Blue
-        } else if (healthPercent >= 0.6f) {
-            shape.setFillColor(sf::Color(144, 238, 144)); // Green
-        } else if (healthPercent >= 0.4f) {
-            shape.setFillColor(sf::Color::Yellow);
-        } else if (healthPercent >= 0.2f) {
-            shape.setFillColor(sf::Color(255, 165, 0)); // Orange
-        } else {
-            shape.setFillColor(sf::Color::Red);
-        }
+        angle = 0.0f;
+        orbitRadius = 150.0f;
     }
 
-    void setShape() override {
-        sf::ConvexShape convex(8);
-        convex.setPoint(0, sf::Vector2f(0, 0));
-        convex.setPoint(1, sf::Vector2f(0, -30));
-        convex.setPoint(2, sf::Vector2f(50, -30));
-        convex.setPoint(3, sf::Vector2f(50, 0));
-        convex.setPoint(4, sf::Vector2f(40, 0));
-        convex.setPoint(5, sf::Vector2f(40, -10));
-        convex.setPoint(6, sf::Vector2f(10, -10));
-        convex.setPoint(7, sf::Vector2f(10, 0));
-        // 50 x 30
-
-        shape = convex;
+    void nextRound() {
+        screenCommand = sim.send({ SimCommandType::NextRound });
     }
-};
-
-class Player : public Destroyable {
-private:
-    float speed;
-    int totalLives;
 
-    bool isAlive;
-    float respawnTimer;
-    float respawnDelay;
-public:
-    Player() {
-        // Match the original struct's life values
-        lives = 2;        // This was currentLives in the struct
-        maxLives = 2;
-        totalLives = 3;
-
-        isAlive = true;
-        respawnTimer = 0.0f;
-        respawnDelay = 5.0f;
-
-        speed = 250.f;
-
-        this->setShape();
-        shape.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2.0f, WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1f)));
+    void clearFleet() {
+        sim.send({ SimCommandType::ClearFleet });
     }
 
-    void setShape() override {
-        sf::ConvexShape convex(6);
-        convex.setPoint(0, sf::Vector2f(0, 0));
-        convex.setPoint(1, sf::Vector2f(0, -10));
-        convex.setPoint(2, sf::Vector2f(15, -30));
-        convex.setPoint(3, sf::Vector2f(40, -30));
-        convex.setPoint(4, sf::Vector2f(55, -10));
-        convex.setPoint(5, sf::Vector2f(55, 0));
-        convex.setOrigin(sf::Vector2f(55. / 2., -30. / 2.));
-
-        shape = convex;
+    void saveGame(const std::string& path) {
+        SimCommand save{ SimCommandType::Save };
+        save.path = path;
+        sim.send(save);
     }
 
-    void updateColor() override {
-        if (!isAlive) {
-            shape.setFillColor(sf::Color::Transparent);
-            return;
-        }
+    // Only the file is read here. The simulation thread checks and loads
+    // it, the game is shown once it did, see finishLoad().
+    bool loadGame(const std::string& path) {
+        MappedFile file;
+        if (!file.open(path)) return false;
 
-        float healthPercent = static_cast<float>(lives) / maxLives;
-
-        if (healthPercent == 1.0f) {
-            shape.setFillColor(sf::Color::White);
-        } else if (healthPercent >= 0.8f) {
-            shape.setFillColor(sf::Color(173, 216, 230)); // Light Blue
-        } else if (healthPercent >= 0.6f) {
-            shape.setFillColor(sf::Color(144, 238, 144)); // Green
-        } else if (healthPercent >= 0.4f) {
-            shape.setFillColor(sf::Color::Yellow);
-        } else if (healthPercent >= 0.2f) {
-            shape.setFillColor(sf::Color(255, 165, 0)); // Orange
-        } else {
-            shape.setFillColor(sf::Color::Red);
-        }
+        SimCommand load{ SimCommandType::Load };
+        load.snapshot.assign(file.data(), file.data() + file.size());
+        pendingLoad = sim.send(load);
+        return true;
     }
 
-    void respawn(bool& isGameOver) {
-        if (totalLives > 0) {
-            isAlive = true;
-            lives = maxLives;
-            updateColor();
-            this->getShape().setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1)));
-        } else {
-            isGameOver = true;
-        }
-    }
+    // Switches to the game once the load went through
+    void finishLoad(const RenderSnapshot& snapshot) {
+        if (pendingLoad == 0 || snapshot.commandsDone < pendingLoad) return;
 
-    void update(float deltaTime, sf::Clock& shootClock, std::vector<Bullet>& bullets, bool& isGameOver) {
-        if (!isAlive) {
-            respawnTimer += deltaTime;
-            if (respawnTimer >= respawnDelay) {
-                respawn(isGameOver);
-                respawnTimer = 0.0f;
-            }
+        if (snapshot.failedLoad == pendingLoad) {
+            std::cerr << "Could not load " << SAVE_PATH << std::endl;
         } else {
-            int dir = sf::Keyboard::isKeyPressed(sf::Keyboard::D) - sf::Keyboard::isKeyPressed(sf::Keyboard::A);
-            shape.move(sf::Vector2f(dir * speed * deltaTime, 0));
-
-            // Player Shooting
-            if (shootClock.getElapsedTime() > sf::seconds(0.45) && sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
-                if (bullets.size() < 50) {
-                    Bullet bullet{ sf::RectangleShape(sf::Vector2f(5, 15)) };
-                    bullet.shape.setPosition(shape.getPosition());
-                    bullet.shape.setOrigin(sf::Vector2f(2.5, 7.5));
-                    bullet.shape.setFillColor(sf::Color::Green);
-
-                    bullets.push_back(bullet);
-                }
-                shootClock.restart();
-            }
-
-            // Bound player pos to screen borders
-            sf::Vector2f playerPos = shape.getPosition();
-            sf::Vector2f playerSize = sf::Vector2f(shape.getPoint(5).x, shape.getPoint(2).y);
-            if (playerPos.x - playerSize.x / 2. < 0) {
-                shape.setPosition(sf::Vector2f(playerSize.x / 2., playerPos.y));
-            }
-            if (playerPos.x + playerSize.x / 2. > WINDOW_SIZE.x) {
-                shape.setPosition(sf::Vector2f(WINDOW_SIZE.x - playerSize.x / 2., playerPos.y));
-            }
+            menuState = Play;
+            mainState = MainMenu;
         }
+        pendingLoad = 0;
     }
-
-    void setIsAlive(bool b) { isAlive = b; }
-    bool& getIsAlive() { return isAlive; }
-    int& getTotalLives() { return totalLives; }
-    float& getRespawnTimer() { return respawnTimer; }
-    float& getRespawnDelay() { return respawnDelay; }
-    void damageTotalLives(int num) { totalLives -= num; }
 };
 
-// Helper functions
-void centerBlockOnGrid(
-    std::vector<Ship>& ships, sf::RenderWindow& window,
-    int gridColumns, int gridRows,
-    float marginX, float marginY
-);
-
-void centerHouseOnGrid(std::vector<House>& houses, sf::RenderWindow& window, float marginX);
-
-struct GameData {
-    sf::RenderWindow& window;
-    Player player;
-    sf::Font font;
-
-    std::vector<Bullet> bullets;
-    std::vector<Bullet> blockBullets;
-
-    std::vector<Ship> ships;
-    std::vector<House> houses;
-
-    sf::Clock shootClock;
-    sf::Clock moveClock;
-    sf::Clock blockClock;
-    sf::Clock restartClock;
-    sf::Clock graceTimeClock;
-
-    int score;
-    int round;
-
-    float angle;
-    float orbitRadius;
-
-    bool showPostRoundMenu;
-    bool isPaused;
-    bool isGameOver;
+void buildMenus(GameData& gameData);
+void buildLayers(GameData& gameData);
+MenuOverlay* activeMenu(GameData& gameData, const RenderSnapshot& snapshot);
 
-    void make() {
-        // Player player;
-        isGameOver = false;
-
-        player.setShape();
-        player.getShape().setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y - (WINDOW_SIZE.y * 0.1)));
-        player.getTotalLives() = 3;
-
-        player.respawn(isGameOver);
-
-        player.updateColor();
-        graceTimeClock.restart();
-
-        round = 1;
-        score = 0;
-
-        angle = 0.0f;
-        orbitRadius = 150.0f;
+// Later make a resource type for every state
+// Every menu is laid out here once. The buttons only ever talk to
+// gameData, which outlives them.
+void buildMenus(GameData& gameData) {
+    const sf::Font& font = gameData.font;
+    const sf::Vector2f buttonSize(120, 40);
+    const float buttonX = WINDOW_SIZE.x / 2.0f - 60;
+    const float centerY = WINDOW_SIZE.y / 2.0f;
+
+    sf::Text text1("Pew-Pew", font, 30);
+    text1.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2. - 110, WINDOW_SIZE.y / 2 - 125));
+    text1.setFillColor(sf::Color::Red);
 
-        houses.clear();
-        ships.clear();
-        bullets.clear();
-        blockBullets.clear();
-
-        int blockAmount = 50;
-        for (int i = 0; i < blockAmount; i++) {
-            Ship ship;
-            ship.setShape();
-            ship.getShape().setFillColor(sf::Color::White);
-            ships.push_back(ship);
-        }
+    sf::Text text2("Panic!", font, 55);
+    text2.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2. - 30, WINDOW_SIZE.y / 2. - 100));
 
-        int gridCol = 10;
-        int gridRow = 5;
-        float marginX = 10;
-        float marginY = 15;
-
-        centerBlockOnGrid(
-            ships, window,
-            gridCol, gridRow,
-            marginX, marginY
-        );
-
-        int houseAmount = 4;
-        for (int i = 0; i < houseAmount; i++) {
-            House house;
-            house.setShape();
-            house.getShape().setFillColor(sf::Color::White);
-            houses.push_back(house);
+    MenuOverlay mainMenu(font, "", WINDOW_SIZE, sf::Color::Transparent);
+    mainMenu.addLabel(text1);
+    mainMenu.addLabel(text2);
+    mainMenu.addButton(Button(sf::Vector2f(buttonX, centerY - 20), buttonSize, "Play", font,
+        [&gameData]() {
+            gameData.mainState = PlayAndLoad;
+        }
+    ));
+    mainMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 40), buttonSize, "Exit", font,
+        [&gameData]() {
+            gameData.isRunning = false;
+        }
+    ));
+
+    MenuOverlay playAndLoadMenu(font, "", WINDOW_SIZE, sf::Color::Transparent);
+    playAndLoadMenu.addLabel(text1);
+    playAndLoadMenu.addLabel(text2);
+    playAndLoadMenu.addButton(Button(sf::Vector2f(buttonX, centerY - 20), buttonSize, "New Game", font,
+        [&gameData]() {
+            gameData.menuState = Play;
+            // it's done second time cause Player when going back from game
+            // may want to play again, therefore data has to be new
+            gameData.make();
+            gameData.mainState = MainMenu;
         }
-
-        centerHouseOnGrid(houses, window, 35.);
-    }
-
-    void saveGame() {
-        // int round
-        // int score
-        // int player.currentLives
-        // int player.totalLives;
-        // std::vector<House> houses
-
-        std::ofstream outFile("data.txt");
-        if (outFile.is_open()) {
-            // +1 casue we will be playing the next round
-            outFile << round + 1 << std::endl;
-            outFile << score << std::endl;
-
-            outFile << player.getLives() << std::endl;
-            outFile << player.getTotalLives() << std::endl;
-
-            outFile << houses.size() << std::endl;
-            for (auto& house : houses) {
-                outFile << house.getLives() << std::endl;
-
-                outFile << house.getShape().getPosition().x << std::endl;
-                outFile << house.getShape().getPosition().y << std::endl;
+    ));
+    playAndLoadMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 40), buttonSize, "Load Game", font,
+        [&gameData]() {
+            if (!gameData.loadGame(SAVE_PATH)) {
+                std::cerr << "Could not load " << SAVE_PATH << std::endl;
             }
-            outFile.close();
         }
-    }
+    ));
+    playAndLoadMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 100), buttonSize, "Back", font,
+        [&gameData]() {
+            gameData.mainState = MainMenu;
+        }
+    ));
 
-    void loadGame() {
-        // int round
-        // int score
-        // int player.currentLives
-        // int player.totalLives;
-        // std::vector<House> houses
+    MenuOverlay pauseMenu(font, "Paused", WINDOW_SIZE);
+    pauseMenu.addButton(Button(sf::Vector2f(buttonX, centerY - 60), buttonSize, "Resume", font,
+        [&gameData]() {
+            gameData.isPaused = false;
+        }
+    ));
+    pauseMenu.addButton(Button(sf::Vector2f(buttonX, centerY), buttonSize, "Restart", font,
+        [&gameData]() {
+            gameData.isPaused = false;
+            gameData.make();
+        }
+    ));
+    pauseMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 60), buttonSize, "Main Menu", font,
+        [&gameData]() {
+            gameData.menuState = Menu;
+            gameData.isPaused = false;
+        }
+    ));
+
+    // Title and score are filled in by playState() once the round is known
+    MenuOverlay postRoundMenu(font, "", WINDOW_SIZE);
+    postRoundMenu.addButton(Button(sf::Vector2f(buttonX, centerY - 20), buttonSize, "Continue", font,
+        [&gameData]() {
+            gameData.saveRequested = false;
+            gameData.nextRound();
+        }
+    ));
+    postRoundMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 40), buttonSize, "Save Game", font,
+        [&gameData]() {
+            gameData.saveGame(SAVE_PATH);
+            gameData.saveRequested = true;
+        }
+    ));
+    postRoundMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 100), buttonSize, "Main Menu", font,
+        [&gameData]() {
+            gameData.menuState = Menu;
+            gameData.saveRequested = false;
+        }
+    ));
+    postRoundMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 160), buttonSize, "Restart", font,
+        [&gameData]() {
+            gameData.make();
+        }
+    ));
 
-        std::ifstream inFile("data.txt");
-        if (inFile.is_open()) {
-            inFile >> round;
-            inFile >> score;
-            inFile >> player.getLives();
-            inFile >> player.getTotalLives();
+    MenuOverlay gameOverMenu(font, "Game Over!", WINDOW_SIZE);
+    gameOverMenu.addButton(Button(sf::Vector2f(buttonX, centerY - 20), buttonSize, "Restart", font,
+        [&gameData]() {
+            gameData.make();
+        }
+    ));
+    gameOverMenu.addButton(Button(sf::Vector2f(buttonX, centerY + 40), buttonSize, "Main Menu", font,
+        [&gameData]() {
+            gameData.menuState = Menu;
+        }
+    ));
 
-            size_t houseSize;
-            inFile >> houseSize;
-            inFile.ignore();
+    gameData.menus = { mainMenu, playAndLoadMenu, pauseMenu, postRoundMenu, gameOverMenu };
 
-            houses.clear();
-            if (houseSize > 0) {
-                for (size_t i = 0; i < houseSize; i++) {
-                    House house;
-                    house.setShape();
+    gameData.saveText = sf::Text("", font, 16);
+    gameData.saveText.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2.0f + 70, WINDOW_SIZE.y / 2.0f + 50));
+}
 
-                    sf::Vector2f pos(0.0, 0.0);
+// Only the part of a planet that is inside the window gets a texture
+sf::FloatRect onScreen(const sf::FloatRect& bounds) {
+    sf::FloatRect visible;
+    sf::FloatRect(0, 0, WINDOW_SIZE.x, WINDOW_SIZE.y).intersects(bounds, visible);
+    return visible;
+}
 
-                    inFile >> house.getLives();
-                    inFile >> pos.x;
-                    inFile >> pos.y;
+void buildLayers(GameData& gameData) {
+    gameData.playEarth.setFillColor(sf::Color::Blue);
+    gameData.playEarth.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y + 400));
+    gameData.playEarth.setOrigin(sf::Vector2f(500, 500));
+    gameData.playEarthLayer.setArea(onScreen(gameData.playEarth.getGlobalBounds()));
 
-                    house.getShape().setPosition(pos);
-                    house.updateColor();
+    gameData.menuEarth.setFillColor(sf::Color::Blue);
+    gameData.menuEarth.setPosition(WINDOW_SIZE.x / 2. - 100, WINDOW_SIZE.y / 2. - 60);
+    gameData.menuEarth.setOrigin(250.f, 250.f);
+    gameData.menuEarthLayer.setArea(onScreen(gameData.menuEarth.getGlobalBounds()));
+}
 
-                    houses.push_back(house);
-                }
-            }
-        }
+// The menu that is up right now and gets the mouse, if any
+MenuOverlay* activeMenu(GameData& gameData, const RenderSnapshot& snapshot) {
+    if (gameData.menuState == Menu) {
+        return &gameData.menus[gameData.mainState == MainMenu ? MainMenuScreen : PlayAndLoadScreen];
+    }
+    if (gameData.isPaused) {
+        return &gameData.menus[PauseScreen];
     }
-};
-
-// Later make a resource type for every state
-void playState(
-    GameData& gameData, sf::Event& event,
-    float dt, MenuState& menuState
-);
-
-void mainMenuState(
-    GameData& gameData, MainMenuState& mainState,
-    sf::Event& event, bool& isRunning,
-    float& dt, MenuState& menuState
-);
 
-void startNewRound(GameData& gameData);
+    // Until the simulation thread has restarted or started the next round
+    // the snapshot still shows the game from before, so no menu is opened
+    // from it. Other commands, such as a save, leave the screen as it is.
+    if (snapshot.commandsDone < gameData.screenCommand) {
+        return nullptr;
+    }
+    if (snapshot.isGameOver) {
+        return &gameData.menus[GameOverScreen];
+    }
+    if (snapshot.roundCleared) {
+        return &gameData.menus[PostRoundScreen];
+    }
+    return nullptr;
+}
 
-sf::Text updateLivesText(const sf::Font& font, const int& totalLives);
-sf::Text updateScoreText(const sf::Font& font, const int& score);
+void playState(GameData& gameData, const RenderSnapshot& snapshot, MenuOverlay* menu);
+void mainMenuState(GameData& gameData, float& dt, MenuOverlay* menu);
+
+InputFrame readKeyboard();
+int runHeadless(int ticks, const SimConfig& config, uint64_t seed, const std::string& recordPath, bool checkAllocations);
+int runReplay(const std::string& path, int fromTick);
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    int ticks = 60 * 60;
+    SimConfig config;
+
+    uint64_t seed = 0;
+    bool fixedSeed = false;
+    std::string recordPath;
+    std::string replayPath;
+    int fromTick = 0;
+    std::string profilePath;
+    float frameRate = 60;
+    bool checkAllocations = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--ticks" && i + 1 < argc) {
+            if (!parseInt(argv[++i], ticks, 0)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--player-bullets" && i + 1 < argc) {
+            if (!parseInt(argv[++i], config.maxPlayerBullets, 1, MAX_BULLETS)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--ship-bullets" && i + 1 < argc) {
+            if (!parseInt(argv[++i], config.maxShipBullets, 1, MAX_BULLETS)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseInt(argv[++i], config.threads, 1)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseUint64(argv[++i], seed)) return badOption(arg, argv[i], USAGE);
+            fixedSeed = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            if (!parseInt(argv[++i], fromTick, 0)) return badOption(arg, argv[i], USAGE);
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (arg == "--check-allocations") {
+            checkAllocations = true;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            if (!parseFloat(argv[++i], frameRate, 0)) return badOption(arg, argv[i], USAGE);
+        }
+    }
+
+    if (!profilePath.empty()) {
+        if (!profiler().openCsv(profilePath)) {
+            std::cerr << "Could not write " << profilePath << std::endl;
+            return 1;
+        }
+        profiler().setEnabled(true);
+    }
+
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, fromTick);
+    }
+
+    if (headless) {
+        return runHeadless(ticks, config, seed, recordPath, checkAllocations);
+    }
 
-int main() {
     sf::RenderWindow window(sf::VideoMode(WINDOW_SIZE.x, WINDOW_SIZE.y), "Window");
+    // A held key sends one KeyPressed, not one per repeat
+    window.setKeyRepeatEnabled(false);
     sf::Font font;
     if (!font.loadFromFile("arial.ttf")) return -1;
 
     // Gives error for some reason
     // It says that there is not a default constructor
     // for ConvexShape yet it compiles ?
-    GameData gameData{ window };
-    gameData.font = font;
-    gameData.make();
-
-    MenuState menuState = Menu;
-    MainMenuState mainState = MainMenu;
-
-    bool isRunning = true;
-    sf::Clock deltaClock;
-
-    while (isRunning) {
-        sf::Event event;
-        float dt = deltaClock.restart().asSeconds();
-
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                isRunning = false;
-            }
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Escape) {
-                    gameData.isPaused = !gameData.isPaused;
-                }
-            }
-        }
-
-        switch (menuState)
-        {
-        case Menu:
-            mainMenuState(
-                gameData, mainState,
-                event, isRunning,
-                dt, menuState
-            );
-            break;
-        case Play:
-            playState(gameData, event, dt, menuState);
-            break;
-        }
+    SaveService saves;
+    SimThread sim(config, saves, readKeyboard);
 
-        window.display();
+    if (!recordPath.empty()) {
+        sim.startRecording();
     }
 
-    window.close();
-    return 0;
-}
-
-void playState(
-    GameData& gameData, sf::Event& event,
-    float dt, MenuState& menuState
-) {
-    sf::Text livesText = updateLivesText(gameData.font, gameData.player.getTotalLives());
-    sf::Text scoreText = updateScoreText(gameData.font, gameData.score);
-
-    sf::Text roundText("Round: " + std::to_string(gameData.round), gameData.font, 20);
-    roundText.setFillColor(sf::Color::Yellow);
-    roundText.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2 - 50, WINDOW_SIZE.y / 10. - 50.));
-
-    if (gameData.ships.empty() && !gameData.showPostRoundMenu) {
-        gameData.showPostRoundMenu = true;
+    // The simulation thread times its ticks into a file of its own,
+    // frames.csv gets a frames.ticks.csv next to it
+    if (!profilePath.empty()) {
+        size_t dot = profilePath.find_last_of('.');
+        std::string ticksPath = dot == std::string::npos
+            ? profilePath + ".ticks"
+            : profilePath.substr(0, dot) + ".ticks" + profilePath.substr(dot);
+        sim.profileTo(ticksPath);
     }
 
-    // Restart game
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::R)) {
-        gameData.make();
-    }
+    GameData gameData(window, saves, sim);
+    gameData.font = font;
+    gameData.profileOverlay.setFont(gameData.font);
+    gameData.hud.setFont(gameData.font);
+    gameData.nextSeed = seed;
+    gameData.fixedSeed = fixedSeed;
+    gameData.make();
 
-    // Testing purpose
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::B)) {
-        gameData.ships.clear();
-    }
+    gameData.isRunning = true;
+    gameData.menuState = Menu;
+    gameData.mainState = MainMenu;
+    buildMenus(gameData);
+    buildLayers(gameData);
 
-    if (!gameData.showPostRoundMenu && !gameData.isPaused && !gameData.isGameOver) {
+    sim.start();
 
-        gameData.player.update(dt, gameData.shootClock, gameData.bullets, gameData.isGameOver);
+    sf::Clock deltaClock;
+    // The window only has to keep up with the screen, see --fps
+    FramePacer pacer(frameRate);
 
-        // Move Player Bullets
-        for (auto it = gameData.bullets.begin(); it != gameData.bullets.end(); ) {
-            it->shape.move(0, -600 * dt);
+    while (gameData.isRunning) {
+        profiler().beginFrame();
 
-            if (it->shape.getPosition().y + it->shape.getSize().y < 0) {
-                it = gameData.bullets.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        sf::Event event;
+        // Menus only animate with it, a stalled window should not make them jump
+        float dt = std::min(deltaClock.restart().asSeconds(), 0.25f);
 
-        // Bullet deals damage to ships
-        for (int bulletId = 0; bulletId < gameData.bullets.size();) {
-            bool bulletHit = false;
-            for (int blockId = 0; blockId < gameData.ships.size(); blockId++) {
-                sf::FloatRect bulletBounds = gameData.bullets[bulletId].shape.getGlobalBounds();
-                sf::FloatRect blockBounds = gameData.ships[blockId].getShape().getGlobalBounds();
-
-                if (bulletBounds.intersects(blockBounds)) {
-                    if (gameData.ships[blockId].getLives() <= 0) {
-                        gameData.ships.erase(gameData.ships.begin() + blockId);
-                        gameData.score += 50;
-                    } else {
-                        gameData.ships[blockId].damage(1);
-                        gameData.ships[blockId].updateColor();
-                        gameData.score += 10;
-                    }
-                    bulletHit = true;
-                    break;
-                }
-            }
+        const RenderSnapshot& snapshot = sim.snapshot();
+        gameData.finishLoad(snapshot);
 
-            if (bulletHit) {
-                gameData.bullets.erase(gameData.bullets.begin() + bulletId);
-            } else {
-                bulletId++;
+        ProfileScope scope(PHASE_INPUT);
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                gameData.isRunning = false;
             }
-        }
-
-        // Player bullets deals damage to the houses
-        for (int bulletId = 0; bulletId < gameData.bullets.size();) {
-            bool bulletHit = false;
-            for (int houseId = 0; houseId < gameData.houses.size(); houseId++) {
-                sf::FloatRect bulletBounds = gameData.bullets[bulletId].shape.getGlobalBounds();
-                sf::FloatRect houseBounds = gameData.houses[houseId].getShape().getGlobalBounds();
-
-                if (bulletBounds.intersects(houseBounds)) {
-                    if (gameData.houses[houseId].getLives() == 0) {
-                        gameData.houses.erase(gameData.houses.begin() + houseId);
-                    } else {
-                        gameData.houses[houseId].damage(1);
-                        gameData.houses[houseId].updateColor();
-                    }
-                    bulletHit = true;
-                    break;
-                }
+            if (event.type == sf::Event::GainedFocus) {
+                sim.setFocused(true);
             }
-
-            if (bulletHit) {
-                gameData.bullets.erase(gameData.bullets.begin() + bulletId);
-            } else {
-                bulletId++;
+            if (event.type == sf::Event::LostFocus) {
+                sim.setFocused(false);
             }
-        }
-
-        // Add a bit of a grace time at the start of the round/game
-        std::vector<Ship> shootableBlocks;
-        if (gameData.graceTimeClock.getElapsedTime() > sf::seconds(1.)) {
-            // Get ships that can shoot
-            for (auto& block : gameData.ships) {
-                sf::FloatRect blockBounds = block.getShape().getGlobalBounds();
-                bool hasBlockBelow = false;
-
-                for (auto& otherBlock : gameData.ships) {
-                    if (&block == &otherBlock) continue;
-
-                    sf::FloatRect otherBlockBounds = otherBlock.getShape().getGlobalBounds();
-
-                    if (blockBounds.left == otherBlockBounds.left &&
-                        blockBounds.top + blockBounds.height + 15 /*MarginX*/ == otherBlockBounds.top) {
-                        hasBlockBelow = true;
-                        break;
-                    }
-                }
-
-                if (!hasBlockBelow) {
-                    // block.shape.setFillColor(sf::Color::Red);
-                    shootableBlocks.push_back(block);
-                }
-            }
-        }
-
-        // Lower the time needed for ships to shoot and move
-        float harder;
-        if (gameData.ships.size() > 2) {
-            harder = (5. / gameData.ships.size()) + (gameData.round * 0.1f);
-        } else {
-            harder = 1.3 + (gameData.round * 0.1f);
-        }
-
-        harder = std::min(harder, 1.5f);
-
-        // Move ships
-        if (gameData.moveClock.getElapsedTime() > sf::seconds(2.0 - harder)) {
-            for (auto& block : gameData.ships) {
-                if (harder > 0.3) {
-                    block.getShape().move(sf::Vector2f(0.0, 3.0));
-                } else {
-                    block.getShape().move(sf::Vector2f(0.0, 1.0));
+            if (event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::Escape) {
+                    gameData.isPaused = !gameData.isPaused;
                 }
-            }
-            gameData.moveClock.restart();
-        }
-
-        // Random amount of bullets are shoot by random amount of the ships
-        if (gameData.blockClock.getElapsedTime() > sf::seconds(3.0 - harder)) {
-            std::vector<int> shootBlockId;
-
-            if (!shootableBlocks.empty() && gameData.blockBullets.size() < 50) {
-                int maxAmount = 4;
-
-                if (shootableBlocks.size() < 5) {
-                    maxAmount = shootableBlocks.size();
+                if (event.key.code == sf::Keyboard::F3) {
+                    gameData.showProfile = !gameData.showProfile;
+                    profiler().setEnabled(gameData.showProfile || !profilePath.empty());
+                    sim.setProfiling(gameData.showProfile || !profilePath.empty());
                 }
 
-                int minAmount = 0;
-
-                int randAmount = rand() % (maxAmount - minAmount + 1) + minAmount;
-                int i = 0;
-
-                while (i < randAmount) {
-                    int randInt = rand() % shootableBlocks.size();
-
-                    if (std::count(shootBlockId.begin(), shootBlockId.end(), randInt)) {
-                        continue;
-                    } else {
-                        shootBlockId.push_back(randInt);
-                        i++;
-                    }
+                // Once per press, the fleet of a restart comes from a cached blueprint
+                if (gameData.menuState == Play && event.key.code == sf::Keyboard::R) {
+                    gameData.make();
                 }
 
-                for (const auto& id : shootBlockId) {
-                    Ship& shootBlock = shootableBlocks[id];
-                    Bullet bullet{ sf::RectangleShape(sf::Vector2f(5, 15)) };
-
-                    sf::Vector2f blockCenter = shootBlock.getShape().getPosition() +
-                        sf::Vector2f(50. / 2.f, 20.);
-
-                    bullet.shape.setPosition(blockCenter);
-                    bullet.shape.setOrigin(sf::Vector2f(2.5, 7.5));
-                    bullet.shape.setFillColor(sf::Color::Red);
-
-                    gameData.blockBullets.push_back(bullet);
+                // Testing purpose
+                if (gameData.menuState == Play && event.key.code == sf::Keyboard::B) {
+                    gameData.clearFleet();
                 }
-
-                gameData.blockClock.restart();
             }
-        }
 
-        // Check if ShootableBlocks are under certain position
-        for (auto& block : shootableBlocks) {
-            if (block.getShape().getPosition().y >= WINDOW_SIZE.y * 0.71) {
-                gameData.isGameOver = true;
+            // Looked up for every event, a click may have switched menus
+            MenuOverlay* menu = activeMenu(gameData, snapshot);
+            if (menu != nullptr) {
+                menu->handleEvent(event);
             }
         }
+        scope.next(-1);
 
-        // Move block bullets
-        for (auto it = gameData.blockBullets.begin(); it != gameData.blockBullets.end(); ) {
-            it->shape.move(0, 600 * dt);
-
-            if (it->shape.getPosition().y > WINDOW_SIZE.y) {
-                it = gameData.blockBullets.erase(it);
-            } else {
-                ++it;
+        MenuOverlay* menu = activeMenu(gameData, snapshot);
+        if (menu != gameData.shownMenu) {
+            gameData.shownMenu = menu;
+            if (menu != nullptr) {
+                menu->hoverAt(sf::Mouse::getPosition(window));
             }
         }
 
-        // Ship bullets destroy houses
-        for (int bulletId = 0; bulletId < gameData.blockBullets.size();) {
-            bool bulletHit = false;
-            for (int houseId = 0; houseId < gameData.houses.size(); houseId++) {
-                sf::FloatRect bulletBounds = gameData.blockBullets[bulletId].shape.getGlobalBounds();
-                sf::FloatRect houseBounds = gameData.houses[houseId].getShape().getGlobalBounds();
-
-                if (bulletBounds.intersects(houseBounds)) {
-                    if (gameData.houses[houseId].getLives() == 0) {
-                        gameData.houses.erase(gameData.houses.begin() + houseId);
-                    } else {
-                        gameData.houses[houseId].damage(1);
-                        gameData.houses[houseId].updateColor();
-                    }
-                    bulletHit = true;
-                    break;
-                }
-            }
-
-            if (bulletHit) {
-                gameData.blockBullets.erase(gameData.blockBullets.begin() + bulletId);
-            } else {
-                bulletId++;
-            }
+        switch (gameData.menuState)
+        {
+        case Menu:
+            mainMenuState(gameData, dt, menu);
+            break;
+        case Play:
+            playState(gameData, snapshot, menu);
+            break;
         }
 
-        // Ship bullets damages player
-        for (int bulletId = 0; bulletId < gameData.blockBullets.size();) {
-            bool bulletHit = false;
-            sf::FloatRect bulletBounds = gameData.blockBullets[bulletId].shape.getGlobalBounds();
-            sf::FloatRect playerBounds = gameData.player.getShape().getGlobalBounds();
-
-            if (bulletBounds.intersects(playerBounds) && gameData.player.getIsAlive()) {
-                gameData.player.damage(1);
-                gameData.player.updateColor();
-
-                if (gameData.player.getLives() <= 0) {
-                    gameData.player.damageTotalLives(1);
-                    gameData.player.getIsAlive() = false;
-                    gameData.player.getRespawnTimer() = 0.0f;
-                }
-
-                bulletHit = true;
-            }
+        sim.setRunning(gameData.menuState == Play && !gameData.isPaused);
 
-            if (bulletHit) {
-                gameData.blockBullets.erase(gameData.blockBullets.begin() + bulletId);
-            } else {
-                bulletId++;
-            }
+        if (gameData.showProfile) {
+            gameData.profileOverlay.draw(window, profiler(), sim.tickProfiler());
         }
-    }
-
-    sf::CircleShape earth(500);
-    earth.setPointCount(50);
-    earth.setFillColor(sf::Color::Blue);
-    earth.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2., WINDOW_SIZE.y + 400));
-    earth.setOrigin(sf::Vector2f(earth.getRadius(), earth.getRadius()));
-
-    gameData.window.clear(sf::Color::Black);
-
-    gameData.window.draw(livesText);
-    gameData.window.draw(scoreText);
-    gameData.window.draw(roundText);
-
-    gameData.window.draw(earth);
 
-    for (auto bullet : gameData.bullets) {
-        gameData.window.draw(bullet.shape);
-    }
-
-    for (auto bullet : gameData.blockBullets) {
-        gameData.window.draw(bullet.shape);
-    }
+        scope.next(PHASE_DISPLAY);
+        window.display();
+        scope.next(-1);
 
-    for (auto block : gameData.ships) {
-        gameData.window.draw(block.getShape());
-    }
+        profiler().endFrame();
 
-    for (auto house : gameData.houses) {
-        gameData.window.draw(house.getShape());
+        pacer.wait();
     }
 
-    gameData.window.draw(gameData.player.getShape());
-
-    // show Pause menu
-    if (gameData.isPaused) {
-        static MenuOverlay pauseMenu(gameData.font, "Paused", WINDOW_SIZE);
-        static bool menuInitialized = false;
-
-        if (!menuInitialized) {
-            Button resumeButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f - 60),
-                sf::Vector2f(120, 40),
-                "Resume",
-                gameData.font,
-                [&]() {
-                    gameData.isPaused = false;
-                }
-            );
-
-            Button restartButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f),
-                sf::Vector2f(120, 40),
-                "Restart",
-                gameData.font,
-                [&]() {
-                    gameData.isPaused = false;
-                    gameData.make();
-                }
-            );
-
-            Button menuButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f + 60),
-                sf::Vector2f(120, 40),
-                "Main Menu",
-                gameData.font,
-                [&]() {
-                    menuState = Menu;
-                    gameData.showPostRoundMenu = false;
-                    gameData.isPaused = false;
-                }
-            );
+    sim.stop();
+    window.close();
 
-            pauseMenu.addButton(resumeButton);
-            pauseMenu.addButton(restartButton);
-            pauseMenu.addButton(menuButton);
-            menuInitialized = true;
+    if (sim.isRecording()) {
+        if (!writeFileAtomic(recordPath, sim.recorder().finish())) {
+            std::cerr << "Could not write " << recordPath << std::endl;
+            return 1;
         }
-
-        pauseMenu.handleEvent(event, gameData.window);
-        pauseMenu.draw(gameData.window);
+        std::cout << "recorded " << sim.recorder().tickCount() << " ticks to " << recordPath << std::endl;
     }
+    return 0;
+}
 
-    // Show Post round menu
-    if (gameData.showPostRoundMenu) {
-        static MenuOverlay postRoundMenu(gameData.font, "Round " + std::to_string(gameData.round) + " Complete!", WINDOW_SIZE);
-        static bool menuInitialized = false;
-
-        if (!menuInitialized) {
-            Button continueButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f - 20),
-                sf::Vector2f(120, 40),
-                "Continue",
-                gameData.font,
-                [&]() {
-                    gameData.round++;
-                    gameData.showPostRoundMenu = false;
-                    menuInitialized = false;
-                    startNewRound(gameData);
-                }
-            );
-
-            Button saveButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f + 40),
-                sf::Vector2f(120, 40),
-                "Save Game",
-                gameData.font,
-                [&]() { gameData.saveGame(); }
-            );
-
-            Button menuButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f + 100),
-                sf::Vector2f(120, 40),
-                "Main Menu",
-                gameData.font,
-                [&]() {
-                    menuState = Menu;
-                    gameData.showPostRoundMenu = false;
-                    menuInitialized = false;
-                }
-            );
-
-            Button restartButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f + 160),
-                sf::Vector2f(120, 40),
-                "Restart",
-                gameData.font,
-                [&]() {
-                    gameData.showPostRoundMenu = false;
-                    gameData.make();
-                }
-            );
-
-            postRoundMenu.addButton(continueButton);
-            postRoundMenu.addButton(saveButton);
-            postRoundMenu.addButton(menuButton);
-            postRoundMenu.addButton(restartButton);
-            postRoundMenu.setScoreText(gameData.font, "Score: " + std::to_string(gameData.score));
-            menuInitialized = true;
-        }
+void playState(GameData& gameData, const RenderSnapshot& snapshot, MenuOverlay* menu) {
+    ProfileScope scope(PHASE_HUD);
 
-        postRoundMenu.handleEvent(event, gameData.window);
-        postRoundMenu.draw(gameData.window);
-    }
+    gameData.hud.update(snapshot.score, snapshot.round, snapshot.totalLives);
 
-    // Show Game Over menu
-    if (gameData.isGameOver) {
-        static MenuOverlay gameOverMenu(gameData.font, "Game Over!", WINDOW_SIZE);
-        static bool menuInitialized = false;
-
-        if (!menuInitialized) {
-            Button restartButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f - 20),
-                sf::Vector2f(120, 40),
-                "Restart",
-                gameData.font,
-                [&]() {
-                    gameData.make();
-                }
-            );
-
-            Button menuButton(
-                sf::Vector2f(WINDOW_SIZE.x / 2.0f - 60, WINDOW_SIZE.y / 2.0f + 40),
-                sf::Vector2f(120, 40),
-                "Main Menu",
-                gameData.font,
-                [&]() {
-                    gameData.isGameOver = false;
-                    menuState = Menu;
-                }
-            );
+    scope.next(PHASE_DRAW);
 
-            gameOverMenu.addButton(restartButton);
-            gameOverMenu.addButton(menuButton);
-            gameOverMenu.setScoreText(gameData.font, "Final Score: " + std::to_string(gameData.score));
-            menuInitialized = true;
-        }
+    gameData.window.clear(sf::Color::Black);
 
-        gameOverMenu.handleEvent(event, gameData.window);
-        gameOverMenu.draw(gameData.window);
+    gameData.hud.draw(gameData.window);
+
+    gameData.playEarthLayer.draw(gameData.window, [&gameData](sf::RenderTarget& target) {
+        target.draw(gameData.playEarth);
+    });
+
+    // How far the frame is between the snapshot's tick and the next one
+    std::chrono::duration<float> sinceTick = std::chrono::steady_clock::now() - snapshot.takenAt;
+    float alpha = std::min(std::max((sinceTick.count() + snapshot.lag) / FIXED_DT, 0.f), 1.f);
+
+    gameData.renderer.draw(gameData.window, snapshot, alpha);
+
+    scope.next(PHASE_MENUS);
+
+    if (menu == nullptr) return;
+
+    if (menu == &gameData.menus[PostRoundScreen] || menu == &gameData.menus[GameOverScreen]) {
+        if (snapshot.round != gameData.shownRound || snapshot.score != gameData.shownScore) {
+            gameData.shownRound = snapshot.round;
+            gameData.shownScore = snapshot.score;
+            gameData.menus[PostRoundScreen].setTitle("Round " + std::to_string(snapshot.round) + " Complete!");
+            gameData.menus[PostRoundScreen].setScoreText("Score: " + std::to_string(snapshot.score));
+            gameData.menus[GameOverScreen].setScoreText("Final Score: " + std::to_string(snapshot.score));
+        }
+    }
+
+    menu->draw(gameData.window);
+
+    if (menu == &gameData.menus[PostRoundScreen] && gameData.saveRequested) {
+        SaveStatus status = gameData.saves.status();
+        if (status != gameData.shownSaveStatus) {
+            gameData.shownSaveStatus = status;
+            gameData.saveText.setFillColor(sf::Color::White);
+            switch (status) {
+            case SaveStatus::Saving:
+                gameData.saveText.setString("Saving...");
+                break;
+            case SaveStatus::Saved:
+                gameData.saveText.setString("Game saved");
+                break;
+            case SaveStatus::Failed:
+                gameData.saveText.setString("Save failed!");
+                gameData.saveText.setFillColor(sf::Color::Red);
+                break;
+            default:
+                gameData.saveText.setString("");
+                break;
+            }
+        }
+        gameData.window.draw(gameData.saveText);
     }
 }
 
-void mainMenuState(
-    GameData& gameData, MainMenuState& mainState,
-    sf::Event& event, bool& isRunning,
-    float& dt, MenuState& menuState
-) {
-    // Main Menu buttons
-    Button playButton(
-        sf::Vector2f(WINDOW_SIZE.x / 2. - 60, WINDOW_SIZE.y / 2. - 20),
-        sf::Vector2f(120, 40),
-        "Play",
-        gameData.font,
-        [&]() {
-            mainState = PlayAndLoad;
-        }
-    );
-
-    Button exitButton(
-        sf::Vector2f(WINDOW_SIZE.x / 2. - 60, WINDOW_SIZE.y / 2. + 40),
-        sf::Vector2f(120, 40),
-        "Exit",
-        gameData.font,
-        [&isRunning]() {isRunning = false;}
-    );
-
-    // Play and Load buttons
-    Button newGameButton(
-        sf::Vector2f(WINDOW_SIZE.x / 2. - 60, WINDOW_SIZE.y / 2. - 20),
-        sf::Vector2f(120, 40),
-        "New Game",
-        gameData.font,
-        [&]() {
-            menuState = Play;
-            // it's done second time cause Player when going back from game
-            // may want to play again, therefore data has to be new
-            gameData.make();
-            mainState = MainMenu;
-        }
-    );
-
-    Button loadGameButton(
-        sf::Vector2f(WINDOW_SIZE.x / 2. - 60, WINDOW_SIZE.y / 2. + 40),
-        sf::Vector2f(120, 40),
-        "Load Game",
-        gameData.font,
-        [&]() {
-            menuState = Play;
-            gameData.loadGame();
-            mainState = MainMenu;
-            startNewRound(gameData);
-        }
-    );
-
-    Button backButton(
-        sf::Vector2f(WINDOW_SIZE.x / 2. - 60, WINDOW_SIZE.y / 2. + 100),
-        sf::Vector2f(120, 40),
-        "Back",
-        gameData.font,
-        [&]() {
-            mainState = MainMenu;
-        }
-    );
-
-    sf::Text text1("Pew-Pew", gameData.font, 30);
-    text1.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2. - 110, WINDOW_SIZE.y / 2 - 125));
-    text1.setFillColor(sf::Color::Red);
-
-    sf::Text text2("Panic!", gameData.font, 55);
-    text2.setPosition(sf::Vector2f(WINDOW_SIZE.x / 2. - 30, WINDOW_SIZE.y / 2. - 100));
+void mainMenuState(GameData& gameData, float& dt, MenuOverlay* menu) {
+    ProfileScope scope(PHASE_MENUS);
 
     // Start of a bunch of math
     float centerX = WINDOW_SIZE.x / 2. - 100;
     float centerY = WINDOW_SIZE.y / 2. - 60;
 
-    sf::CircleShape earth(250.f);
-    earth.setFillColor(sf::Color::Blue);
-    earth.setPosition(centerX, centerY);
-    earth.setOrigin(earth.getRadius(), earth.getRadius());
-
     sf::CircleShape moon(80.f);
     moon.setFillColor(sf::Color(200, 200, 200));
     moon.setOrigin(moon.getRadius(), moon.getRadius());
@@ -1141,175 +687,232 @@ void mainMenuState(
     moon.setFillColor(sf::Color(brightness, brightness, brightness));
     // End of a bunch of math
 
+    scope.next(PHASE_DRAW);
 
     gameData.window.clear(sf::Color::Black);
 
+    auto paintEarth = [&gameData](sf::RenderTarget& target) {
+        target.draw(gameData.menuEarth);
+    };
+
     if (zPos < 0) {
         gameData.window.draw(moon);
-        gameData.window.draw(earth);
+        gameData.menuEarthLayer.draw(gameData.window, paintEarth);
     } else {
-        gameData.window.draw(earth);
+        gameData.menuEarthLayer.draw(gameData.window, paintEarth);
         gameData.window.draw(moon);
     }
 
-    switch (mainState)
-    {
-    case MainMenu:
-        playButton.handleEvent(event, gameData.window);
-        exitButton.handleEvent(event, gameData.window);
-
-        playButton.draw(gameData.window);
-        exitButton.draw(gameData.window);
-        break;
-    case PlayAndLoad:
-        newGameButton.handleEvent(event, gameData.window);
-        loadGameButton.handleEvent(event, gameData.window);
-        backButton.handleEvent(event, gameData.window);
-
-        newGameButton.draw(gameData.window);
-        loadGameButton.draw(gameData.window);
-        backButton.draw(gameData.window);
-        break;
-    }
-
-    gameData.window.draw(text1);
-    gameData.window.draw(text2);
+    menu->draw(gameData.window);
 
     gameData.angle += 0.7f * dt;
 }
 
-void centerBlockOnGrid(
-    std::vector<Ship>& ships, sf::RenderWindow& window,
-    int gridColumns, int gridRows,
-    float marginX, float marginY
-) {
-    if (ships.empty() || gridColumns <= 0 || gridRows <= 0) return;
+InputFrame readKeyboard() {
+    InputFrame input;
+    input.moveDir = sf::Keyboard::isKeyPressed(sf::Keyboard::D) - sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+    input.shoot = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+    return input;
+}
+
+// Runs the game without a window as fast as possible.
+// The sweep bot plays, rounds are continued and lost games restarted, so
+// any number of ticks can be soaked through.
+//
+// With checkAllocations every tick after the first WARM_UP_TICKS has to get
+// by without the heap, apart from the ones that start a round or a game.
+// The run fails on the first tick that allocates and names its phases.
+// Ticks --check-allocations lets a game run before it checks, the scratch
+// buffers grow to fit during those
+const int WARM_UP_TICKS = 600;
+
+// Prints what the tick that just ended allocated, false if it did
+bool checkTickAllocations(int tick) {
+    if (profiler().lastFrameAllocations(Profiler::FRAME_TOTAL) == 0) return true;
+
+    std::cerr << "tick " << tick << " allocated:" << std::endl;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (profiler().lastFrameAllocations(phase) > 0) {
+            std::cerr << "  " << phaseName(phase) << ": " << profiler().lastFrameAllocations(phase) << std::endl;
+        }
+    }
+    return false;
+}
+
+// Normal play has a few dozen bullets in flight at most, too few for the
+// bullet passes to be split across threads. This keeps CROWDED_BULLETS of
+// each owner in flight on at least CROWDED_THREADS threads, so the job
+// system is checked too.
+bool checkCrowdedAllocations(const SimConfig& config, uint64_t seed) {
+    const int CROWDED_TICKS = 3000;
+    const int CROWDED_BULLETS = 1000;
+    const int CROWDED_THREADS = 4;
 
-    sf::Vector2f rectSize = sf::Vector2f(50, 20);
+    SimConfig crowded = config;
+    crowded.threads = std::max(config.threads, CROWDED_THREADS);
+    crowded.maxPlayerBullets = std::max(config.maxPlayerBullets, CROWDED_BULLETS);
+    crowded.maxShipBullets = std::max(config.maxShipBullets, CROWDED_BULLETS);
 
-    float gridWidth = gridColumns * rectSize.x + (gridColumns - 1) * marginX;
-    float gridHeight = gridRows * rectSize.y + (gridRows - 1) * marginY;
+    Simulation sim;
+    sim.setConfig(crowded);
+    sim.make(seed);
 
-    float startX = ((WINDOW_SIZE.x - gridWidth) / 2.0f);
-    float startY = ((WINDOW_SIZE.y - gridHeight) / 2.0f) - (WINDOW_SIZE.y - gridHeight) * 0.30;
+    int spawned = 0;
+    for (int tick = 0; tick < CROWDED_TICKS; tick++) {
+        profiler().beginFrame();
+        bool startedRound = false;
 
-    int count = 0;
-    for (int row = 0; row < gridRows; ++row) {
-        int livesForRow = gridRows - row;
+        if (sim.ships.empty()) {
+            sim.nextRound();
+            startedRound = true;
+        }
+        if (sim.isGameOver) {
+            sim.make(++seed);
+            startedRound = true;
+        }
 
-        for (int col = 0; col < gridColumns; ++col) {
-            if (count >= ships.size()) break;
+        // Spread over the width, player bullets from the bottom and ship
+        // bullets from the top
+        while (sim.bullets.countOf(BulletOwner::Player) < CROWDED_BULLETS) {
+            float x = static_cast<float>(spawned++ * 37 % static_cast<int>(WINDOW_SIZE.x));
+            sim.bullets.spawn(sf::Vector2f(x, WINDOW_SIZE.y), sf::Vector2f(0, -BULLET_SPEED), BulletOwner::Player);
+        }
+        while (sim.bullets.countOf(BulletOwner::Ship) < CROWDED_BULLETS) {
+            float x = static_cast<float>(spawned++ * 37 % static_cast<int>(WINDOW_SIZE.x));
+            sim.bullets.spawn(sf::Vector2f(x, 0), sf::Vector2f(0, BULLET_SPEED), BulletOwner::Ship);
+        }
 
-            float x = startX + col * (rectSize.x + marginX);
-            float y = startY + row * (rectSize.y + marginY);
+        sim.step(sweepBot(sim, tick), FIXED_DT);
+        profiler().endFrame();
 
-            ships[count].getShape().setPosition(x, y);
-            ships[count].getLives() = livesForRow;
-            ships[count].getMaxLives() = livesForRow;
-            ships[count].updateColor();
-            ++count;
+        if (tick >= WARM_UP_TICKS && !startedRound && !checkTickAllocations(tick)) {
+            std::cerr << "with " << sim.bullets.size() << " bullets on " << crowded.threads << " threads" << std::endl;
+            return false;
         }
     }
+    return true;
 }
 
-void centerHouseOnGrid(std::vector<House>& houses, sf::RenderWindow& window, float marginX) {
-    if (houses.empty()) return;
+int runHeadless(int ticks, const SimConfig& config, uint64_t seed, const std::string& recordPath, bool checkAllocations) {
 
-    // 50 x 30
-    sf::Vector2f rectSize = sf::Vector2f(50, 30);
+    if (checkAllocations) {
+        if (!ALLOCATION_TRACKING) {
+            std::cerr << "--check-allocations needs a build with INFA_TRACK_ALLOCATIONS" << std::endl;
+            return 1;
+        }
+        // The replay grows with every tick
+        if (!recordPath.empty()) {
+            std::cerr << "--check-allocations can not be combined with --record" << std::endl;
+            return 1;
+        }
+        // Allocations are charged to the phase the profiler has open
+        profiler().setEnabled(true);
+    }
 
-    int numHouses = houses.size();
-    float largeMargin = marginX * 3;
-    float totalWidth = (numHouses * rectSize.x) + ((numHouses - 1) * largeMargin);
-    float startX = (WINDOW_SIZE.x - totalWidth) / 2.0f;
-    float y = WINDOW_SIZE.y * 0.82f;
+    Simulation sim;
+    sim.setConfig(config);
+    sim.make(seed);
 
-    for (int i = 0; i < numHouses; ++i) {
-        float x = startX + i * (rectSize.x + largeMargin);
-        houses[i].getShape().setPosition(x, y);
+    ReplayRecorder recorder;
+    bool recording = !recordPath.empty();
+    if (recording) recorder.begin(sim);
 
-        houses[i].updateColor();
-    }
-}
+    int roundsCleared = 0;
+    int gamesOver = 0;
 
-void startNewRound(GameData& gameData) {
-    gameData.bullets.clear();
-    gameData.blockBullets.clear();
-
-    gameData.player.getLives() = std::min(gameData.player.getLives() + 1, gameData.player.getMaxLives());
-    gameData.player.updateColor();
-    gameData.player.setIsAlive(true);
-    gameData.player.respawn(gameData.isGameOver);
-
-    gameData.graceTimeClock.restart();
-
-    // Create ships with increased health based on round
-    gameData.ships.clear();
-    int shipsAmount = 50 + (gameData.round - 1) * 3;
-    for (int i = 0; i < shipsAmount; i++) {
-        Ship ship;
-        ship.setShape();
-        ship.getShape().setFillColor(sf::Color::White);
-        gameData.ships.push_back(ship);
-    }
+    auto start = std::chrono::steady_clock::now();
 
-    int gridCol = 10;
-    int gridRow = (shipsAmount + gridCol - 1) / gridCol; // Calculate rows needed
-    float marginX = 10;
-    float marginY = 15;
-
-    centerBlockOnGrid(
-        gameData.ships, gameData.window,
-        gridCol, gridRow,
-        marginX, marginY
-    );
-
-    // Increase block health based on round
-    for (auto& block : gameData.ships) {
-        block.getMaxLives() += (gameData.round - 1);
-        block.getLives() = block.getMaxLives();
-        block.updateColor();
-    }
+    for (int tick = 0; tick < ticks; tick++) {
+        // Every tick is a frame as far as --profile is concerned
+        profiler().beginFrame();
+        bool startedRound = false;
 
-    // Repair houses slightly between rounds or make new ones
-    if (gameData.houses.size() > 0) {
-        for (auto& house : gameData.houses) {
-            house.getLives() = std::min(house.getLives() + 2, house.getMaxLives());
-            house.updateColor();
+        if (sim.ships.empty()) {
+            sim.nextRound();
+            if (recording) recorder.recordNextRound();
+            roundsCleared++;
+            startedRound = true;
         }
-    } else {
-        int houseAmount = std::min(gameData.round, 4);
-        for (int i = 0; i < houseAmount; i++) {
-            House house;
-            house.setShape();
-            house.getShape().setFillColor(sf::Color::White);
-            gameData.houses.push_back(house);
+
+        if (sim.isGameOver) {
+            seed++;
+            sim.make(seed);
+            if (recording) recorder.recordRestart(seed);
+            gamesOver++;
+            startedRound = true;
         }
 
-        centerHouseOnGrid(gameData.houses, gameData.window, 35.);
+        InputFrame input = sweepBot(sim, tick);
+
+        if (recording) recorder.recordStep(sim, input, FIXED_DT);
+        sim.step(input, FIXED_DT);
+
+        profiler().endFrame();
+
+        if (checkAllocations && tick >= WARM_UP_TICKS && !startedRound && !checkTickAllocations(tick)) {
+            return 1;
+        }
     }
-}
 
-sf::Text updateLivesText(const sf::Font& font, const int& totalLives) {
-    sf::Text livesText("", font, 20);
-    std::string str;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
 
-    for (int i = 0; i < totalLives; i++) {
-        str += "<3 ";
+    std::cout << "ticks: " << ticks << std::endl;
+    std::cout << "rounds cleared: " << roundsCleared << std::endl;
+    std::cout << "games over: " << gamesOver << std::endl;
+    std::cout << "seconds: " << seconds << std::endl;
+    std::cout << "ticks/s: " << (seconds > 0 ? ticks / seconds : 0) << std::endl;
+
+    // Same number from a replay of this run means it was reproduced exactly
+    std::vector<char> state = sim.saveSnapshot();
+    std::cout << "state crc: " << std::hex << crc32(state.data(), state.size()) << std::dec << std::endl;
+
+    if (recording && !writeFileAtomic(recordPath, recorder.finish())) {
+        std::cerr << "Could not write " << recordPath << std::endl;
+        return 1;
     }
 
-    livesText.setString(str);
-    livesText.setFillColor(sf::Color::Red);
-    livesText.setPosition(sf::Vector2f(10., WINDOW_SIZE.y / 10. - 50.));
+    if (checkAllocations && !checkCrowdedAllocations(config, seed)) {
+        return 1;
+    }
 
-    return livesText;
+    return 0;
 }
 
-sf::Text updateScoreText(const sf::Font& font, const int& score) {
-    sf::Text scoreText("Score: ", font, 20);
-    scoreText.setString("Score: " + std::to_string(score));
-    scoreText.setFillColor(sf::Color::Green);
-    scoreText.setPosition(sf::Vector2f(WINDOW_SIZE.x - 120., WINDOW_SIZE.y / 10. - 50.));
+// Plays a replay file as fast as possible, from the given tick to the end
+int runReplay(const std::string& path, int fromTick) {
+    ReplayPlayer replay;
+    if (!replay.open(path)) {
+        std::cerr << "Could not read replay " << path << std::endl;
+        return 1;
+    }
+
+    Simulation sim;
+    if (!replay.seek(sim, std::max(fromTick, 0))) {
+        std::cerr << "Replay " << path << " is broken" << std::endl;
+        return 1;
+    }
+
+    uint32_t startTick = replay.tick();
+    auto start = std::chrono::steady_clock::now();
+
+    while (!replay.atEnd()) {
+        if (!replay.advance(sim)) {
+            std::cerr << "Replay " << path << " is broken at tick " << replay.tick() << std::endl;
+            return 1;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+    uint32_t played = replay.tick() - startTick;
+
+    std::cout << "ticks: " << startTick << " to " << replay.tick() << std::endl;
+    std::cout << "seconds: " << seconds << std::endl;
+    std::cout << "ticks/s: " << (seconds > 0 ? played / seconds : 0) << std::endl;
 
-    return scoreText;
+    std::vector<char> state = sim.saveSnapshot();
+    std::cout << "state crc: " << std::hex << crc32(state.data(), state.size()) << std::dec << std::endl;
+
+    return 0;
 }
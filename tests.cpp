@@ -0,0 +1,114 @@
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SaveFile.hpp"
+#include "Simulation.hpp"
+
+// Checks that need no window, run by ctest. Prints every failed check and
+// exits with 1 if there was one.
+//
+//   ./infa_tests
+
+namespace {
+
+// Snapshot header and section table, see SaveFile.hpp
+const size_t HEADER_SIZE = 16;
+const size_t ENTRY_SIZE = 12;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// A game some way into its first round, with bullets in flight
+void playGame(Simulation& sim) {
+    sim.make(3);
+    InputFrame input;
+    input.shoot = true;
+    for (int tick = 0; tick < 600; tick++) {
+        sim.step(input, FIXED_DT);
+    }
+}
+
+// Overwrites an int32 at offset into a section and fixes up the CRC, so
+// only the value itself is wrong
+void patchInt(std::vector<char>& snapshot, uint32_t section, size_t offset, int32_t value) {
+    uint16_t count;
+    std::memcpy(&count, snapshot.data() + 6, sizeof(count));
+    for (uint16_t i = 0; i < count; i++) {
+        size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+        uint32_t id, start;
+        std::memcpy(&id, snapshot.data() + entry, sizeof(id));
+        std::memcpy(&start, snapshot.data() + entry + 4, sizeof(start));
+        if (id == section) {
+            std::memcpy(snapshot.data() + start + offset, &value, sizeof(value));
+        }
+    }
+    uint32_t crc = crc32(snapshot.data() + HEADER_SIZE, snapshot.size() - HEADER_SIZE);
+    std::memcpy(snapshot.data() + 8, &crc, sizeof(crc));
+}
+
+// Loading the damaged snapshot has to fail and leave the game as it was
+void checkRefused(const std::string& what, const std::function<void(std::vector<char>&)>& damage) {
+    Simulation sim;
+    playGame(sim);
+    std::vector<char> before = sim.saveSnapshot();
+    std::vector<char> damaged = before;
+    damage(damaged);
+
+    check(!sim.loadSnapshot(damaged.data(), damaged.size()), what + " is refused");
+    check(sim.saveSnapshot() == before, what + " leaves the game alone");
+}
+
+void testSnapshotLives() {
+    Simulation sim;
+    playGame(sim);
+    std::vector<char> snapshot = sim.saveSnapshot();
+    Simulation loaded;
+    check(loaded.loadSnapshot(snapshot.data(), snapshot.size()), "an undamaged snapshot loads");
+    check(loaded.saveSnapshot() == snapshot, "a loaded snapshot saves the same bytes");
+
+    // Player: lives, total lives
+    checkRefused("negative player lives", [](std::vector<char>& s) { patchInt(s, SECTION_PLAYER, 0, -1); });
+    checkRefused("player lives above the most", [](std::vector<char>& s) {
+        patchInt(s, SECTION_PLAYER, 0, PlayerKind::START_LIVES + 1);
+    });
+    checkRefused("negative total lives", [](std::vector<char>& s) { patchInt(s, SECTION_PLAYER, 4, -1); });
+
+    // Houses: count, then lives, max lives, position per house
+    checkRefused("negative house lives", [](std::vector<char>& s) { patchInt(s, SECTION_HOUSES, 4, -1); });
+    checkRefused("house lives above its most", [](std::vector<char>& s) {
+        patchInt(s, SECTION_HOUSES, 4, HouseKind::START_LIVES + 1);
+    });
+    checkRefused("huge house lives", [](std::vector<char>& s) {
+        patchInt(s, SECTION_HOUSES, 4, 2000000000);
+        patchInt(s, SECTION_HOUSES, 8, 2000000000);
+    });
+
+    // Fleet: 28 bytes of layout, then column, row, lives, max lives per ship
+    checkRefused("negative ship lives", [](std::vector<char>& s) { patchInt(s, SECTION_FLEET, 28 + 8, -1); });
+    checkRefused("huge ship lives", [](std::vector<char>& s) {
+        patchInt(s, SECTION_FLEET, 28 + 8, 2000000000);
+        patchInt(s, SECTION_FLEET, 28 + 12, 2000000000);
+    });
+}
+
+}
+
+int main() {
+    testSnapshotLives();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}